@@ -0,0 +1,190 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the ways DBPostProcess has scored a box, the mean of the
+// probability map over the box as cv::fillPoly rasterizes it:
+//   legacy   - a zeroed mask per box, cv::fillPoly and cv::mean,
+//   mask     - one reused mask, cv::fillPoly and a masked sum,
+//   scanline - PolygonRaster runs summed in place, no mask.
+// All three visit the same pixels in the same order; the program checks that
+// they agree exactly.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <opencv2/opencv.hpp>
+#include <random>
+#include <vector>
+
+#include "src/common/polygon_raster.h"
+
+namespace {
+
+struct Roi {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+Roi BoxRoi(const cv::Mat &bitmap, const std::vector<cv::Point> &box) {
+  int xmin = box[0].x, xmax = box[0].x, ymin = box[0].y, ymax = box[0].y;
+  for (const auto &point : box) {
+    xmin = std::min(xmin, point.x);
+    xmax = std::max(xmax, point.x);
+    ymin = std::min(ymin, point.y);
+    ymax = std::max(ymax, point.y);
+  }
+  xmin = std::min(std::max(0, xmin), bitmap.cols - 1);
+  xmax = std::min(std::max(0, xmax), bitmap.cols - 1);
+  ymin = std::min(std::max(0, ymin), bitmap.rows - 1);
+  ymax = std::min(std::max(0, ymax), bitmap.rows - 1);
+  return Roi{xmin, ymin, xmax - xmin + 1, ymax - ymin + 1};
+}
+
+std::vector<cv::Point> Shift(const std::vector<cv::Point> &box,
+                             const Roi &roi) {
+  std::vector<cv::Point> points;
+  for (const auto &point : box) {
+    points.emplace_back(point.x - roi.x, point.y - roi.y);
+  }
+  return points;
+}
+
+double LegacyMean(const cv::Mat &bitmap, const std::vector<cv::Point> &box) {
+  Roi roi = BoxRoi(bitmap, box);
+  cv::Mat mask = cv::Mat::zeros(roi.height, roi.width, CV_8UC1);
+  std::vector<std::vector<cv::Point>> polygons = {Shift(box, roi)};
+  cv::fillPoly(mask, polygons, cv::Scalar(1));
+  cv::Rect rect(roi.x, roi.y, roi.width, roi.height);
+  return cv::mean(bitmap(rect), mask)[0];
+}
+
+double MaskMean(const cv::Mat &bitmap, const std::vector<cv::Point> &box,
+                cv::Mat &mask_buffer) {
+  Roi roi = BoxRoi(bitmap, box);
+  if (mask_buffer.rows < roi.height || mask_buffer.cols < roi.width) {
+    mask_buffer.create(std::max(mask_buffer.rows, roi.height),
+                       std::max(mask_buffer.cols, roi.width), CV_8UC1);
+  }
+  cv::Mat mask = mask_buffer(cv::Rect(0, 0, roi.width, roi.height));
+  mask.setTo(0);
+  std::vector<cv::Point> points = Shift(box, roi);
+  const cv::Point *polygon = points.data();
+  int npts = static_cast<int>(points.size());
+  cv::fillPoly(mask, &polygon, &npts, 1, cv::Scalar(1));
+  double sum = 0.0;
+  size_t count = 0;
+  for (int y = 0; y < roi.height; ++y) {
+    const uchar *mask_row = mask.ptr<uchar>(y);
+    const float *row = bitmap.ptr<float>(roi.y + y) + roi.x;
+    for (int x = 0; x < roi.width; ++x) {
+      if (mask_row[x]) {
+        sum += row[x];
+        count++;
+      }
+    }
+  }
+  return count > 0 ? sum * (1.0 / count) : 0.0;
+}
+
+double ScanlineMean(const cv::Mat &bitmap, const std::vector<cv::Point> &box) {
+  Roi roi = BoxRoi(bitmap, box);
+  cv::Point points[PolygonRaster::kInlineVertices];
+  int npts = static_cast<int>(box.size());
+  for (int i = 0; i < npts; ++i) {
+    points[i] = cv::Point(box[i].x - roi.x, box[i].y - roi.y);
+  }
+  PolygonRaster raster(points, npts, roi.width, roi.height);
+  double sum = 0.0;
+  size_t count =
+      raster.Sum(bitmap.ptr<float>(roi.y) + roi.x, bitmap.step1(0), &sum);
+  return count > 0 ? sum * (1.0 / count) : 0.0;
+}
+
+double NowUs() {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+template <typename Score>
+double UsPerBox(const std::vector<std::vector<cv::Point>> &boxes, int rounds,
+                Score score) {
+  volatile double sink = 0.0;
+  double start = NowUs();
+  for (int r = 0; r < rounds; ++r) {
+    for (const auto &box : boxes) {
+      sink = sink + score(box);
+    }
+  }
+  return (NowUs() - start) / (static_cast<double>(rounds) * boxes.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int rounds = argc > 1 ? std::atoi(argv[1]) : 20;
+  const int kSide = 960;
+  cv::Mat bitmap(kSide, kSide, CV_32FC1);
+  cv::randu(bitmap, 0.0f, 1.0f);
+
+  // Rotated text-line boxes as BoxesFromBitmap scores them, some of them
+  // crossing the border of the map.
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> center(-20.0f, kSide + 20.0f);
+  std::uniform_real_distribution<float> length(8.0f, 400.0f);
+  std::uniform_real_distribution<float> thickness(6.0f, 48.0f);
+  std::uniform_real_distribution<float> angle(-8.0f, 8.0f);
+  std::vector<std::vector<cv::Point>> boxes;
+  for (int i = 0; i < 2000; ++i) {
+    cv::RotatedRect rect(cv::Point2f(center(rng), center(rng)),
+                         cv::Size2f(length(rng), thickness(rng)),
+                         i % 4 == 0 ? 0.0f : angle(rng));
+    cv::Point2f corners[4];
+    rect.points(corners);
+    std::vector<cv::Point> box;
+    for (const auto &corner : corners) {
+      box.emplace_back(static_cast<int>(corner.x), static_cast<int>(corner.y));
+    }
+    boxes.push_back(box);
+  }
+
+  cv::Mat mask_buffer;
+  for (const auto &box : boxes) {
+    double legacy = LegacyMean(bitmap, box);
+    double scanline = ScanlineMean(bitmap, box);
+    if (MaskMean(bitmap, box, mask_buffer) != scanline || legacy != scanline) {
+      std::printf("scores differ: legacy %.9f scanline %.9f\n", legacy,
+                  scanline);
+      return 1;
+    }
+  }
+
+  std::printf("boxes: %zu, rounds: %d\n", boxes.size(), rounds);
+  std::printf("legacy   %8.2f us/box\n",
+              UsPerBox(boxes, rounds, [&](const std::vector<cv::Point> &box) {
+                return LegacyMean(bitmap, box);
+              }));
+  std::printf("mask     %8.2f us/box\n",
+              UsPerBox(boxes, rounds, [&](const std::vector<cv::Point> &box) {
+                return MaskMean(bitmap, box, mask_buffer);
+              }));
+  std::printf("scanline %8.2f us/box\n",
+              UsPerBox(boxes, rounds, [&](const std::vector<cv::Point> &box) {
+                return ScanlineMean(bitmap, box);
+              }));
+  return 0;
+}
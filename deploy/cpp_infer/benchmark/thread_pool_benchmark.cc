@@ -0,0 +1,178 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares PaddlePool::ThreadPool with the lazily started single-queue pool
+// it replaced: submit/get round trips, bursts of small tasks, and the CPU
+// time the workers burn while the pool sits idle.
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <unordered_map>
+
+#include "src/common/thread_pool.h"
+
+namespace {
+
+// The previous pool: one mutex-guarded queue, threads started on demand in
+// submit() and retired after two idle seconds.
+class LegacyThreadPool {
+public:
+  using MutexGuard = std::lock_guard<std::mutex>;
+  using UniqueLock = std::unique_lock<std::mutex>;
+  using Task = std::function<void()>;
+
+  explicit LegacyThreadPool(size_t maxThreads) : maxThreads_(maxThreads) {}
+
+  ~LegacyThreadPool() {
+    {
+      MutexGuard guard(mutex_);
+      quit_ = true;
+    }
+    cv_.notify_all();
+    for (auto &elem : threads_) {
+      elem.second.join();
+    }
+  }
+
+  template <typename Func>
+  auto submit(Func &&func)
+      -> std::future<typename std::result_of<Func()>::type> {
+    using ReturnType = typename std::result_of<Func()>::type;
+    auto task = std::make_shared<std::packaged_task<ReturnType()>>(
+        std::forward<Func>(func));
+    auto result = task->get_future();
+    MutexGuard guard(mutex_);
+    tasks_.emplace([task]() { (*task)(); });
+    if (idleThreads_ > 0) {
+      cv_.notify_one();
+    } else if (currentThreads_ < maxThreads_) {
+      std::thread t(&LegacyThreadPool::worker, this);
+      threads_[t.get_id()] = std::move(t);
+      ++currentThreads_;
+    }
+    return result;
+  }
+
+private:
+  void worker() {
+    while (true) {
+      Task task;
+      {
+        UniqueLock lock(mutex_);
+        ++idleThreads_;
+        bool timedOut = !cv_.wait_for(lock, std::chrono::seconds(2), [this]() {
+          return quit_ || !tasks_.empty();
+        });
+        --idleThreads_;
+        if (tasks_.empty() && (quit_ || timedOut)) {
+          // Retired threads are joined by the destructor.
+          --currentThreads_;
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+
+  bool quit_ = false;
+  size_t currentThreads_ = 0;
+  size_t idleThreads_ = 0;
+  size_t maxThreads_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::queue<Task> tasks_;
+  std::unordered_map<std::thread::id, std::thread> threads_;
+};
+
+double NowUs() {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+double CpuUs() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec * 1e6 + usage.ru_utime.tv_usec +
+         usage.ru_stime.tv_sec * 1e6 + usage.ru_stime.tv_usec;
+}
+
+template <typename Pool> double RoundTripUs(Pool &pool, int iterations) {
+  volatile int sink = 0;
+  double start = NowUs();
+  for (int i = 0; i < iterations; ++i) {
+    pool.submit([&sink]() { sink = sink + 1; }).get();
+  }
+  return (NowUs() - start) / iterations;
+}
+
+template <typename Pool>
+double BurstUsPerTask(Pool &pool, int bursts, int burst_size) {
+  std::atomic<int> sink(0);
+  std::vector<std::future<void>> futures;
+  futures.reserve(burst_size);
+  double start = NowUs();
+  for (int b = 0; b < bursts; ++b) {
+    for (int i = 0; i < burst_size; ++i) {
+      futures.push_back(pool.submit([&sink]() { ++sink; }));
+    }
+    for (auto &future : futures) {
+      future.get();
+    }
+    futures.clear();
+  }
+  return (NowUs() - start) / (bursts * burst_size);
+}
+
+// CPU time used by the whole process while the warmed-up pool has no work.
+template <typename Pool> double IdleCpuUs(Pool &pool, int idle_ms) {
+  BurstUsPerTask(pool, 1, 64);
+  double start = CpuUs();
+  std::this_thread::sleep_for(std::chrono::milliseconds(idle_ms));
+  return CpuUs() - start;
+}
+
+template <typename Pool> void Report(const char *name, Pool &pool) {
+  std::printf("%-8s round trip %7.2f us   burst %6.2f us/task   idle %8.0f "
+              "us cpu/s\n",
+              name, RoundTripUs(pool, 20000), BurstUsPerTask(pool, 2000, 32),
+              IdleCpuUs(pool, 1000));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                            : std::thread::hardware_concurrency();
+  std::printf("threads: %zu\n", threads);
+  {
+    LegacyThreadPool pool(threads);
+    Report("legacy", pool);
+  }
+  {
+    PaddlePool::ThreadPool pool(threads);
+    Report("pool", pool);
+  }
+  {
+    PaddlePool::ThreadPool pool(threads, 2000);
+    Report("spin", pool);
+  }
+  return 0;
+}
@@ -178,6 +178,16 @@ GetPipelineMoudleParams() {
     det_params.input_shape =
         YamlConfig::SmartParseVector(FLAGS_text_det_input_shape).vec_int;
   }
+  if (!FLAGS_text_det_bucket_sizes.empty()) {
+    ocr_params.text_det_bucket_sizes =
+        YamlConfig::SmartParseVector(FLAGS_text_det_bucket_sizes).vec_int;
+    det_params.bucket_sizes =
+        YamlConfig::SmartParseVector(FLAGS_text_det_bucket_sizes).vec_int;
+  }
+  if (!FLAGS_text_det_reduced_decode.empty()) {
+    ocr_params.text_det_reduced_decode =
+        Utility::StringToBool(FLAGS_text_det_reduced_decode);
+  }
   if (!FLAGS_text_rec_score_thresh.empty()) {
     ocr_params.text_rec_score_thresh = std::stof(FLAGS_text_rec_score_thresh);
   }
@@ -185,6 +195,10 @@ GetPipelineMoudleParams() {
     ocr_params.text_rec_input_shape =
         YamlConfig::SmartParseVector(FLAGS_text_rec_input_shape).vec_int;
   }
+  if (!FLAGS_text_rec_cross_image_batching.empty()) {
+    ocr_params.text_rec_cross_image_batching =
+        Utility::StringToBool(FLAGS_text_rec_cross_image_batching);
+  }
   if (!FLAGS_lang.empty()) {
     ocr_params.lang = FLAGS_lang;
   }
@@ -250,6 +264,22 @@ GetPipelineMoudleParams() {
     ocr_params.thread_num = std::stoi(FLAGS_thread_num);
     doc_pre_params.thread_num = std::stoi(FLAGS_thread_num);
   }
+  if (!FLAGS_parallel_mode.empty()) {
+    ocr_params.parallel_mode = FLAGS_parallel_mode;
+  }
+  if (!FLAGS_stage_replicas.empty()) {
+    ocr_params.stage_replicas =
+        YamlConfig::SmartParseVector(FLAGS_stage_replicas).vec_int;
+  }
+  if (!FLAGS_stage_queue_size.empty()) {
+    ocr_params.stage_queue_size = std::stoi(FLAGS_stage_queue_size);
+  }
+  if (!FLAGS_prefetch_batches.empty()) {
+    ocr_params.prefetch_batches = std::stoi(FLAGS_prefetch_batches);
+  }
+  if (!FLAGS_pipeline_batch_size.empty()) {
+    ocr_params.pipeline_batch_size = std::stoi(FLAGS_pipeline_batch_size);
+  }
   if (!FLAGS_paddlex_config.empty()) {
     ocr_params.paddlex_config = FLAGS_paddlex_config;
     doc_pre_params.paddlex_config = FLAGS_paddlex_config;
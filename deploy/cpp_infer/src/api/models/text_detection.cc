@@ -55,6 +55,8 @@ TextDetection::ToTextDetectionModelParams(const TextDetectionParams &from) {
   COPY_PARAMS(box_thresh)
   COPY_PARAMS(unclip_ratio)
   COPY_PARAMS(input_shape)
+  COPY_PARAMS(bucket_sizes)
+  COPY_PARAMS(batch_size)
   COPY_PARAMS(device)
   COPY_PARAMS(enable_mkldnn)
   COPY_PARAMS(mkldnn_cache_capacity)
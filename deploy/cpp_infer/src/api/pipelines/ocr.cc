@@ -31,6 +31,26 @@ std::vector<std::unique_ptr<BaseCVResult>>
 PaddleOCR::Predict(const std::vector<std::string> &input) {
   return pipeline_infer_->Predict(input);
 }
+std::vector<std::unique_ptr<BaseCVResult>>
+PaddleOCR::Predict(const std::vector<cv::Mat> &input,
+                   const std::vector<std::string> &input_path) {
+  return pipeline_infer_->Predict(input, input_path);
+}
+std::vector<std::unique_ptr<BaseCVResult>>
+PaddleOCR::Predict(const std::vector<std::vector<unsigned char>> &input,
+                   const std::vector<std::string> &input_path) {
+  std::vector<cv::Mat> images = {};
+  images.reserve(input.size());
+  for (auto &buffer : input) {
+    auto image = Utility::MyDecodeImage(buffer);
+    if (!image.ok()) {
+      INFOE("Decode input fail : %s", image.status().ToString().c_str());
+      exit(-1);
+    }
+    images.push_back(image.value());
+  }
+  return pipeline_infer_->Predict(images, input_path);
+}
 void PaddleOCR::CreatePipeline() {
   pipeline_infer_ = std::unique_ptr<BasePipeline>(
       new OCRPipeline(ToOCRPipelineParams(params_)));
@@ -84,17 +104,25 @@ OCRPipelineParams PaddleOCR::ToOCRPipelineParams(const PaddleOCRParams &from) {
   COPY_PARAMS(text_det_box_thresh)
   COPY_PARAMS(text_det_unclip_ratio)
   COPY_PARAMS(text_det_input_shape)
+  COPY_PARAMS(text_det_bucket_sizes)
+  COPY_PARAMS(text_det_reduced_decode)
   COPY_PARAMS(text_rec_score_thresh)
   COPY_PARAMS(text_rec_input_shape)
+  COPY_PARAMS(text_rec_cross_image_batching)
   COPY_PARAMS(lang)
   COPY_PARAMS(ocr_version)
   COPY_PARAMS(vis_font_dir)
   COPY_PARAMS(device)
+  COPY_PARAMS(pipeline_batch_size)
   COPY_PARAMS(enable_mkldnn)
   COPY_PARAMS(mkldnn_cache_capacity)
   COPY_PARAMS(precision)
   COPY_PARAMS(cpu_threads)
   COPY_PARAMS(thread_num)
+  COPY_PARAMS(parallel_mode)
+  COPY_PARAMS(stage_replicas)
+  COPY_PARAMS(stage_queue_size)
+  COPY_PARAMS(prefetch_batches)
   COPY_PARAMS(paddlex_config)
   return to;
 }
@@ -40,17 +40,25 @@ struct PaddleOCRParams {
   absl::optional<float> text_det_box_thresh = absl::nullopt;
   absl::optional<float> text_det_unclip_ratio = absl::nullopt;
   absl::optional<std::vector<int>> text_det_input_shape = absl::nullopt;
+  absl::optional<std::vector<int>> text_det_bucket_sizes = absl::nullopt;
+  absl::optional<bool> text_det_reduced_decode = absl::nullopt;
   absl::optional<float> text_rec_score_thresh = absl::nullopt;
   absl::optional<std::vector<int>> text_rec_input_shape = absl::nullopt;
+  absl::optional<bool> text_rec_cross_image_batching = absl::nullopt;
   absl::optional<std::string> lang = absl::nullopt;
   absl::optional<std::string> ocr_version = absl::nullopt;
   absl::optional<std::string> vis_font_dir = absl::nullopt;
   absl::optional<std::string> device = absl::nullopt;
+  absl::optional<int> pipeline_batch_size = absl::nullopt;
   bool enable_mkldnn = true;
   int mkldnn_cache_capacity = 10;
   std::string precision = "fp32";
   int cpu_threads = 8;
   int thread_num = 1;
+  std::string parallel_mode = "replica";
+  std::vector<int> stage_replicas = {1, 1, 1, 1};
+  int stage_queue_size = 4;
+  int prefetch_batches = 2;
   absl::optional<Utility::PaddleXConfigVariant> paddlex_config = absl::nullopt;
 };
 
@@ -64,6 +72,14 @@ public:
   };
   std::vector<std::unique_ptr<BaseCVResult>>
   Predict(const std::vector<std::string> &input);
+  // input_path is optional, it is only copied into the results.
+  std::vector<std::unique_ptr<BaseCVResult>>
+  Predict(const std::vector<cv::Mat> &input,
+          const std::vector<std::string> &input_path = {});
+  // Encoded images such as JPEG or PNG file contents.
+  std::vector<std::unique_ptr<BaseCVResult>>
+  Predict(const std::vector<std::vector<unsigned char>> &input,
+          const std::vector<std::string> &input_path = {});
 
   void CreatePipeline();
   absl::Status CheckParams();
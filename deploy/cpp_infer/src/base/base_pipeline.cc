@@ -13,3 +13,10 @@
 // limitations under the License.
 
 #include "base_pipeline.h"
+
+std::vector<std::unique_ptr<BaseCVResult>>
+BasePipeline::Predict(const std::vector<cv::Mat> &input,
+                      const std::vector<std::string> &input_path) {
+  INFOE("This pipeline does not support decoded image input.");
+  exit(-1);
+}
@@ -24,6 +24,14 @@
 #include "absl/status/statusor.h"
 #include "base_cv_result.h"
 #include "base_predictor.h"
+#include "src/utils/ilogger.h"
+
+// Input of one pipeline call: either paths to read, or decoded images with
+// optional paths as metadata.
+struct PipelineInputData {
+  std::vector<std::string> input_path = {};
+  std::vector<cv::Mat> input_image = {};
+};
 
 class BasePipeline {
 public:
@@ -35,9 +43,23 @@ public:
     return Predict(inputs);
   }
 
+  std::vector<std::unique_ptr<BaseCVResult>>
+  Predict(const PipelineInputData &input) {
+    if (input.input_image.empty()) {
+      return Predict(input.input_path);
+    }
+    return Predict(input.input_image, input.input_path);
+  }
+
   virtual std::vector<std::unique_ptr<BaseCVResult>>
   Predict(const std::vector<std::string> &input) = 0;
 
+  // Predicts on images that are already decoded. input_path is optional
+  // metadata, either empty or one path per image.
+  virtual std::vector<std::unique_ptr<BaseCVResult>>
+  Predict(const std::vector<cv::Mat> &input,
+          const std::vector<std::string> &input_path);
+
   template <typename T, typename... Args>
   std::unique_ptr<BasePredictor> CreateModule(Args &&...args);
 
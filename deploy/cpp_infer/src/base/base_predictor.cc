@@ -154,9 +154,17 @@ const PaddlePredictorOption &BasePredictor::PPOption() {
 
 void BasePredictor::SetBatchSize(int batch_size) { batch_size_ = batch_size; }
 
-std::unique_ptr<PaddleInfer> BasePredictor::CreateStaticInfer() {
-  return std::unique_ptr<PaddleInfer>(new PaddleInfer(
-      model_name_, model_dir_.value(), MODEL_FILE_PREFIX, PPOption()));
+std::unique_ptr<PaddleInfer>
+BasePredictor::CreateStaticInfer(const std::vector<std::string> &output_names) {
+  std::vector<std::string> selected_outputs = output_names;
+  if (selected_outputs.empty() && config_.HasKey("Global.output_names").ok()) {
+    selected_outputs =
+        YamlConfig::SmartParseVector(config_.Data().at("Global.output_names"))
+            .vec_string;
+  }
+  return std::unique_ptr<PaddleInfer>(
+      new PaddleInfer(model_name_, model_dir_.value(), MODEL_FILE_PREFIX,
+                      PPOption(), selected_outputs));
 }
 
 absl::Status BasePredictor::BuildBatchSampler() {
@@ -44,7 +44,10 @@ public:
   template <typename T>
   std::vector<std::unique_ptr<BaseCVResult>> Predict(const T &input);
 
-  std::unique_ptr<PaddleInfer> CreateStaticInfer();
+  // Fetches `output_names` if given, else `Global.output_names` from the
+  // model config, else only the first output.
+  std::unique_ptr<PaddleInfer>
+  CreateStaticInfer(const std::vector<std::string> &output_names = {});
 
   const PaddlePredictorOption &PPOption();
   absl::StatusOr<std::string> ModelName() { return model_name_; };
@@ -64,6 +67,8 @@ public:
   template <typename T, typename... Args>
   void Register(const std::string &key, Args &&...args);
 
+  TensorArena::Stats ArenaStats() const { return arena_.GetStats(); };
+
   static constexpr const char *MODEL_FILE_PREFIX = "inference";
   static const std::unordered_set<std::string> SAMPLER_TYPE;
   static bool print_flag;
@@ -78,11 +83,13 @@ protected:
   std::string model_name_;
   std::string sampler_type_;
   std::unordered_map<std::string, std::unique_ptr<BaseProcessor>> pre_op_;
+  TensorArena arena_;
 };
 
 template <typename T, typename... Args>
 void BasePredictor::Register(const std::string &key, Args &&...args) {
   auto instance = std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+  instance->SetArena(&arena_);
   pre_op_[key] = std::move(instance);
 };
 
@@ -0,0 +1,204 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Bounded multi-producer multi-consumer ring buffer (D. Vyukov). TryPush and
+// TryPop never take a lock; the blocking Push and Pop spin briefly and then
+// park on a condition variable until the other side makes room or data. The
+// other side only takes the lock when someone is parked.
+template <typename T> class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity);
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  bool TryPush(T &&value);
+  bool TryPop(T &value);
+
+  void Push(T &&value);
+  // Returns false once the queue is closed and drained.
+  bool Pop(T &value);
+
+  // Wakes every blocked Pop, which then drains what is left and returns false.
+  void Close();
+  bool Closed() const { return closed_.load(std::memory_order_acquire); }
+  size_t Capacity() const { return mask_ + 1; }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  static constexpr size_t kCacheLine = 64;
+  static constexpr int kSpinCount = 64;
+
+  void WakeWaiters(std::atomic<int> &waiters, std::condition_variable &cv);
+
+  std::unique_ptr<Cell[]> buffer_;
+  size_t mask_;
+  char pad0_[kCacheLine];
+  std::atomic<size_t> enqueue_pos_{0};
+  char pad1_[kCacheLine];
+  std::atomic<size_t> dequeue_pos_{0};
+  char pad2_[kCacheLine];
+  std::atomic<bool> closed_{false};
+  std::atomic<int> push_waiters_{0};
+  std::atomic<int> pop_waiters_{0};
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
+
+template <typename T> BoundedQueue<T>::BoundedQueue(size_t capacity) {
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  buffer_ = std::unique_ptr<Cell[]>(new Cell[size]);
+  mask_ = size - 1;
+  for (size_t i = 0; i < size; i++) {
+    buffer_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <typename T> bool BoundedQueue<T>::TryPush(T &&value) {
+  Cell *cell;
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &buffer_[pos & mask_];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->data = std::move(value);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T> bool BoundedQueue<T>::TryPop(T &value) {
+  Cell *cell;
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &buffer_[pos & mask_];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff =
+        static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  value = std::move(cell->data);
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+// A waiter registers itself and then re-checks the ring under mutex_, while
+// the other side updates the ring and then reads the waiter count. The fences
+// order the two, so either the waiter sees the update or the other side sees
+// the waiter and notifies it; the notify cannot fall between the re-check and
+// the wait because it takes mutex_ first.
+template <typename T>
+void BoundedQueue<T>::WakeWaiters(std::atomic<int> &waiters,
+                                  std::condition_variable &cv) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv.notify_all();
+  }
+}
+
+template <typename T> void BoundedQueue<T>::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_.store(true, std::memory_order_release);
+  }
+  not_empty_.notify_all();
+}
+
+template <typename T> void BoundedQueue<T>::Push(T &&value) {
+  for (int i = 0; i < kSpinCount; i++) {
+    if (TryPush(std::move(value))) {
+      WakeWaiters(pop_waiters_, not_empty_);
+      return;
+    }
+    std::this_thread::yield();
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    push_waiters_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    not_full_.wait(lock, [&]() { return TryPush(std::move(value)); });
+    push_waiters_.fetch_sub(1);
+  }
+  WakeWaiters(pop_waiters_, not_empty_);
+}
+
+template <typename T> bool BoundedQueue<T>::Pop(T &value) {
+  bool popped = false;
+  for (int i = 0; i < kSpinCount && !popped; i++) {
+    popped = TryPop(value);
+    if (!popped) {
+      if (Closed()) {
+        popped = TryPop(value);
+        break;
+      }
+      std::this_thread::yield();
+    }
+  }
+  if (!popped && !Closed()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pop_waiters_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    not_empty_.wait(lock, [&]() {
+      popped = TryPop(value);
+      return popped || Closed();
+    });
+    pop_waiters_.fetch_sub(1);
+    if (!popped) {
+      popped = TryPop(value);
+    }
+  }
+  if (popped) {
+    WakeWaiters(push_waiters_, not_full_);
+  }
+  return popped;
+}
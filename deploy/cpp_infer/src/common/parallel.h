@@ -15,6 +15,8 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -30,16 +32,30 @@ template <typename Pipeline, typename PipelineParams, typename PipelineInput,
           typename PipelineResult>
 class AutoParallelSimpleInferencePipeline : public BasePipeline {
 private:
+  struct Task {
+    PipelineInput input;
+    std::promise<PipelineResult> promise;
+  };
+  // Each instance owns a deque. Its worker takes tasks from the front and
+  // idle workers steal from the back of the deepest deque.
   struct InferenceInstance {
     std::shared_ptr<BasePipeline> pipeline;
-    std::queue<PipelineInput> task_queue;
-    std::queue<std::promise<PipelineResult>> promise_queue;
+    std::deque<Task> task_queue;
     std::mutex queue_mutex;
     std::atomic<bool> is_busy{false};
+    std::atomic<size_t> steal_count{0};
+    std::atomic<size_t> processed_count{0};
     int instance_id;
   };
 
 public:
+  struct InstanceStats {
+    int instance_id;
+    size_t queue_depth;
+    size_t steal_count;
+    size_t processed_count;
+  };
+
   AutoParallelSimpleInferencePipeline(const PipelineParams &params);
   absl::Status Init();
 
@@ -48,10 +64,16 @@ public:
   absl::Status PredictThread(const PipelineInput &input);
   absl::StatusOr<PipelineResult> GetResult();
 
+  std::vector<InstanceStats> GetInstanceStats();
+
   virtual ~AutoParallelSimpleInferencePipeline();
 
 private:
   void ProcessInstanceTasks(int instance_id);
+  bool PopTask(int instance_id, Task &task);
+  bool StealTask(int instance_id, Task &task);
+  bool HasPendingTask();
+  bool WakeInstance(int instance_id);
   PipelineParams params_;
   int thread_num_;
 
@@ -110,25 +132,112 @@ template <typename Pipeline, typename PipelineParams, typename PipelineInput,
 std::future<PipelineResult> AutoParallelSimpleInferencePipeline<
     Pipeline, PipelineParams, PipelineInput,
     PipelineResult>::PredictAsync(const PipelineInput &input) {
-  int instance_id = round_robin_index_.fetch_add(1) % thread_num_;
+  // Prefer an idle instance, starting from the round robin position.
+  int start = round_robin_index_.fetch_add(1) % thread_num_;
+  int instance_id = start;
+  for (int i = 0; i < thread_num_; i++) {
+    int candidate = (start + i) % thread_num_;
+    if (!instances_[candidate]->is_busy.load()) {
+      instance_id = candidate;
+      break;
+    }
+  }
   auto &instance = instances_[instance_id];
 
-  std::promise<PipelineResult> promise;
-  auto future = promise.get_future();
-
+  Task task;
+  task.input = input;
+  auto future = task.promise.get_future();
   {
     std::lock_guard<std::mutex> lock(instance->queue_mutex);
-    instance->task_queue.push(input);
-    instance->promise_queue.push(std::move(promise));
+    instance->task_queue.push_back(std::move(task));
+  }
+
+  // If the owner is still busy with a slow input, an idle instance is
+  // woken to steal the task instead of waiting behind it.
+  if (!WakeInstance(instance_id)) {
+    for (int i = 1; i < thread_num_; i++) {
+      int candidate = (instance_id + i) % thread_num_;
+      if (WakeInstance(candidate)) {
+        break;
+      }
+    }
   }
+  return future;
+}
 
+template <typename Pipeline, typename PipelineParams, typename PipelineInput,
+          typename PipelineResult>
+bool AutoParallelSimpleInferencePipeline<
+    Pipeline, PipelineParams, PipelineInput,
+    PipelineResult>::WakeInstance(int instance_id) {
   bool expected = false;
-  if (instance->is_busy.compare_exchange_strong(
+  if (!instances_[instance_id]->is_busy.compare_exchange_strong(
           expected, true)) { // one instance just process one input
-    pool_->submit([this, instance_id]() { ProcessInstanceTasks(instance_id); });
+    return false;
   }
+  pool_->submit([this, instance_id]() { ProcessInstanceTasks(instance_id); });
+  return true;
+}
 
-  return future;
+template <typename Pipeline, typename PipelineParams, typename PipelineInput,
+          typename PipelineResult>
+bool AutoParallelSimpleInferencePipeline<
+    Pipeline, PipelineParams, PipelineInput,
+    PipelineResult>::PopTask(int instance_id, Task &task) {
+  auto &instance = instances_[instance_id];
+  std::lock_guard<std::mutex> lock(instance->queue_mutex);
+  if (instance->task_queue.empty()) {
+    return false;
+  }
+  task = std::move(instance->task_queue.front());
+  instance->task_queue.pop_front();
+  return true;
+}
+
+template <typename Pipeline, typename PipelineParams, typename PipelineInput,
+          typename PipelineResult>
+bool AutoParallelSimpleInferencePipeline<
+    Pipeline, PipelineParams, PipelineInput,
+    PipelineResult>::StealTask(int instance_id, Task &task) {
+  while (true) {
+    int victim = -1;
+    size_t victim_depth = 0;
+    for (int i = 0; i < thread_num_; i++) {
+      if (i == instance_id) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(instances_[i]->queue_mutex);
+      if (instances_[i]->task_queue.size() > victim_depth) {
+        victim = i;
+        victim_depth = instances_[i]->task_queue.size();
+      }
+    }
+    if (victim < 0) {
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> lock(instances_[victim]->queue_mutex);
+      if (!instances_[victim]->task_queue.empty()) {
+        task = std::move(instances_[victim]->task_queue.back());
+        instances_[victim]->task_queue.pop_back();
+        instances_[instance_id]->steal_count++;
+        return true;
+      }
+    }
+  }
+}
+
+template <typename Pipeline, typename PipelineParams, typename PipelineInput,
+          typename PipelineResult>
+bool AutoParallelSimpleInferencePipeline<
+    Pipeline, PipelineParams, PipelineInput, PipelineResult>::HasPendingTask() {
+  for (auto &instance : instances_) {
+    std::lock_guard<std::mutex> lock(instance->queue_mutex);
+    if (!instance->task_queue.empty()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 template <typename Pipeline, typename PipelineParams, typename PipelineInput,
@@ -139,33 +248,47 @@ void AutoParallelSimpleInferencePipeline<
   auto &instance = instances_[instance_id];
 
   while (true) {
-    std::vector<std::string> input;
-    std::promise<PipelineResult> promise;
-    {
-      std::lock_guard<std::mutex> lock(instance->queue_mutex);
-      if (instance->task_queue.empty()) {
-        instance->is_busy = false;
-
-        if (!instance->task_queue.empty()) {
-          bool expected = false;
-          if (instance->is_busy.compare_exchange_strong(expected, true)) {
-            continue;
-          }
+    Task task;
+    if (!PopTask(instance_id, task) && !StealTask(instance_id, task)) {
+      instance->is_busy = false;
+      // A task may have been queued after the scan above.
+      if (HasPendingTask()) {
+        bool expected = false;
+        if (instance->is_busy.compare_exchange_strong(expected, true)) {
+          continue;
         }
-        return;
       }
-      input = std::move(instance->task_queue.front());
-      instance->task_queue.pop();
-      promise = std::move(instance->promise_queue.front());
-      instance->promise_queue.pop();
+      return;
     }
     try {
-      PipelineResult result = instance->pipeline->Predict(input);
-      promise.set_value(std::move(result));
+      PipelineResult result = instance->pipeline->Predict(task.input);
+      task.promise.set_value(std::move(result));
     } catch (const std::exception &e) {
-      promise.set_exception(std::current_exception());
+      task.promise.set_exception(std::current_exception());
+    }
+    instance->processed_count++;
+  }
+}
+
+template <typename Pipeline, typename PipelineParams, typename PipelineInput,
+          typename PipelineResult>
+std::vector<typename AutoParallelSimpleInferencePipeline<
+    Pipeline, PipelineParams, PipelineInput, PipelineResult>::InstanceStats>
+AutoParallelSimpleInferencePipeline<Pipeline, PipelineParams, PipelineInput,
+                                    PipelineResult>::GetInstanceStats() {
+  std::vector<InstanceStats> stats = {};
+  for (auto &instance : instances_) {
+    InstanceStats item;
+    item.instance_id = instance->instance_id;
+    {
+      std::lock_guard<std::mutex> lock(instance->queue_mutex);
+      item.queue_depth = instance->task_queue.size();
     }
+    item.steal_count = instance->steal_count.load();
+    item.processed_count = instance->processed_count.load();
+    stats.push_back(item);
   }
+  return stats;
 }
 
 template <typename Pipeline, typename PipelineParams, typename PipelineInput,
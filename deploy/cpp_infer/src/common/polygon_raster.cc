@@ -0,0 +1,270 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "polygon_raster.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr int kXYShift = 16;
+constexpr int64_t kXYOne = int64_t(1) << kXYShift;
+
+bool Inside(int x, int y, int width, int height) {
+  return static_cast<unsigned>(x) < static_cast<unsigned>(width) &&
+         static_cast<unsigned>(y) < static_cast<unsigned>(height);
+}
+
+// Same arithmetic as cv::clipLine, so clipped edges land on the same pixels.
+bool ClipLine(int64_t width, int64_t height, int64_t &x1, int64_t &y1,
+              int64_t &x2, int64_t &y2) {
+  int64_t right = width - 1;
+  int64_t bottom = height - 1;
+  if (width <= 0 || height <= 0) {
+    return false;
+  }
+  int c1 = (x1 < 0) + (x1 > right) * 2 + (y1 < 0) * 4 + (y1 > bottom) * 8;
+  int c2 = (x2 < 0) + (x2 > right) * 2 + (y2 < 0) * 4 + (y2 > bottom) * 8;
+  if ((c1 & c2) == 0 && (c1 | c2) != 0) {
+    int64_t a;
+    if (c1 & 12) {
+      a = c1 < 8 ? 0 : bottom;
+      x1 += static_cast<int64_t>(static_cast<double>(a - y1) * (x2 - x1) /
+                                 (y2 - y1));
+      y1 = a;
+      c1 = (x1 < 0) + (x1 > right) * 2;
+    }
+    if (c2 & 12) {
+      a = c2 < 8 ? 0 : bottom;
+      x2 += static_cast<int64_t>(static_cast<double>(a - y2) * (x2 - x1) /
+                                 (y2 - y1));
+      y2 = a;
+      c2 = (x2 < 0) + (x2 > right) * 2;
+    }
+    if ((c1 & c2) == 0 && (c1 | c2) != 0) {
+      if (c1) {
+        a = c1 == 1 ? 0 : right;
+        y1 += static_cast<int64_t>(static_cast<double>(a - x1) * (y2 - y1) /
+                                   (x2 - x1));
+        x1 = a;
+        c1 = 0;
+      }
+      if (c2) {
+        a = c2 == 1 ? 0 : right;
+        y2 += static_cast<int64_t>(static_cast<double>(a - x2) * (y2 - y1) /
+                                   (x2 - x1));
+        x2 = a;
+        c2 = 0;
+      }
+    }
+  }
+  return (c1 | c2) == 0;
+}
+
+} // namespace
+
+void PolygonRaster::Reserve(int count) {
+  edges_ = inline_edges_;
+  lines_ = inline_lines_;
+  xs_ = inline_xs_;
+  runs_ = inline_runs_;
+  if (count > kInlineVertices) {
+    heap_edges_.resize(count);
+    heap_lines_.resize(count);
+    heap_xs_.resize(count);
+    heap_runs_.resize(2 * count);
+    edges_ = heap_edges_.data();
+    lines_ = heap_lines_.data();
+    xs_ = heap_xs_.data();
+    runs_ = heap_runs_.data();
+  }
+}
+
+void PolygonRaster::AddSegment(int x0, int y0, int x1, int y1) {
+  int64_t cx0 = x0, cy0 = y0, cx1 = x1, cy1 = y1;
+  bool clipped = !Inside(x0, y0, width_, height_) ||
+                 !Inside(x1, y1, width_, height_);
+  bool visible = true;
+  if (clipped) {
+    visible = ClipLine(width_, height_, cx0, cy0, cx1, cy1);
+  }
+
+  // The outline, drawn left to right like cv::line.
+  if (visible) {
+    int lx0 = static_cast<int>(cx0), ly0 = static_cast<int>(cy0);
+    int lx1 = static_cast<int>(cx1), ly1 = static_cast<int>(cy1);
+    if (lx1 < lx0) {
+      std::swap(lx0, lx1);
+      std::swap(ly0, ly1);
+    }
+    int dx = lx1 - lx0;
+    int dy = ly1 - ly0;
+    Line &line = lines_[num_lines_++];
+    line.step_y = dy < 0 ? -1 : 1;
+    dy = dy < 0 ? -dy : dy;
+    line.x0 = lx0;
+    line.y0 = ly0;
+    line.steep = dy > dx;
+    line.major = line.steep ? dy : dx;
+    line.minor = line.steep ? dx : dy;
+  }
+
+  // The interior. A clipped edge keeps the rows of the original one and the
+  // slope of the clipped one, as in cv::fillPoly.
+  if (y0 == y1) {
+    return;
+  }
+  int64_t ax = x0 * kXYOne, ay = y0;
+  int64_t bx = x1 * kXYOne, by = y1;
+  if (clipped) {
+    ax = cx0 * kXYOne;
+    ay = cy0;
+    bx = cx1 * kXYOne;
+    by = cy1;
+  }
+  Edge &edge = edges_[num_edges_++];
+  edge.dx = by != ay ? (bx - ax) / (by - ay) : 0;
+  if (y0 < y1) {
+    edge.y0 = y0;
+    edge.y1 = y1;
+    edge.x = ax + (y0 - ay) * edge.dx;
+  } else {
+    edge.y0 = y1;
+    edge.y1 = y0;
+    edge.x = bx + (y1 - by) * edge.dx;
+  }
+}
+
+void PolygonRaster::Finish() {
+  // cv::fillPoly skips the interior of polygons entirely off the image.
+  fill_ = num_edges_ >= 2;
+  if (!fill_) {
+    return;
+  }
+  int min_y = std::numeric_limits<int>::max();
+  int max_y = std::numeric_limits<int>::min();
+  int64_t min_x = std::numeric_limits<int64_t>::max();
+  int64_t max_x = std::numeric_limits<int64_t>::min();
+  for (int i = 0; i < num_edges_; i++) {
+    const Edge &edge = edges_[i];
+    int64_t end_x = edge.x + (edge.y1 - edge.y0) * edge.dx;
+    min_y = std::min(min_y, edge.y0);
+    max_y = std::max(max_y, edge.y1);
+    min_x = std::min(min_x, std::min(edge.x, end_x));
+    max_x = std::max(max_x, std::max(edge.x, end_x));
+  }
+  fill_ = !(max_y < 0 || min_y >= height_ || max_x < 0 ||
+            min_x >= width_ * kXYOne);
+}
+
+bool PolygonRaster::LineRun(const Line &line, int y, Run *run) const {
+  int64_t offset = static_cast<int64_t>(y - line.y0) * line.step_y;
+  if (offset < 0) {
+    return false;
+  }
+  // Minor offset of pixel k is floor((2 * minor * k + major - 1) /
+  // (2 * major)); the x-major case inverts it to find the pixels of a row.
+  int64_t major = line.major;
+  int64_t minor = line.minor;
+  if (line.steep) {
+    if (offset > major) {
+      return false;
+    }
+    run->begin = run->end =
+        line.x0 + static_cast<int>((2 * minor * offset + major - 1) /
+                                   (2 * major));
+    return true;
+  }
+  if (offset > minor) {
+    return false;
+  }
+  auto last = [&](int64_t m) {
+    return minor == 0 ? major
+                      : std::min(major, (2 * major * m + major) / (2 * minor));
+  };
+  int64_t first = offset == 0 ? 0 : last(offset - 1) + 1;
+  int64_t end = last(offset);
+  if (first > end) {
+    return false;
+  }
+  run->begin = line.x0 + static_cast<int>(first);
+  run->end = line.x0 + static_cast<int>(end);
+  return true;
+}
+
+int PolygonRaster::Row(int y, const Run **runs) {
+  *runs = runs_;
+  if (y < begin_row_ || y >= end_row_) {
+    return 0;
+  }
+  int num_runs = 0;
+  for (int i = 0; i < num_lines_; i++) {
+    if (LineRun(lines_[i], y, &runs_[num_runs])) {
+      num_runs++;
+    }
+  }
+  if (fill_) {
+    int num_xs = 0;
+    for (int i = 0; i < num_edges_; i++) {
+      const Edge &edge = edges_[i];
+      if (edge.y0 <= y && y < edge.y1) {
+        xs_[num_xs++] = edge.x + (y - edge.y0) * edge.dx;
+      }
+    }
+    std::sort(xs_, xs_ + num_xs);
+    for (int i = 0; i + 1 < num_xs; i += 2) {
+      int left = static_cast<int>((xs_[i] + kXYOne - 1) >> kXYShift);
+      int right = static_cast<int>(xs_[i + 1] >> kXYShift);
+      if (left < width_ && right >= 0) {
+        left = std::max(left, 0);
+        right = std::min(right, width_ - 1);
+        if (left <= right) {
+          runs_[num_runs++] = Run{left, right};
+        }
+      }
+    }
+  }
+  std::sort(runs_, runs_ + num_runs,
+            [](const Run &a, const Run &b) { return a.begin < b.begin; });
+  int merged = 0;
+  for (int i = 0; i < num_runs; i++) {
+    if (merged > 0 && runs_[i].begin <= runs_[merged - 1].end + 1) {
+      runs_[merged - 1].end = std::max(runs_[merged - 1].end, runs_[i].end);
+    } else {
+      runs_[merged++] = runs_[i];
+    }
+  }
+  return merged;
+}
+
+size_t PolygonRaster::Sum(const float *data, size_t step, double *sum) {
+  // Kept next to Row() so that it can be inlined and the accumulator stays in
+  // a register across rows.
+  double total = *sum;
+  size_t count = 0;
+  for (int y = begin_row_; y < end_row_; ++y) {
+    const Run *runs;
+    int num_runs = Row(y, &runs);
+    const float *row = data + y * step;
+    for (int i = 0; i < num_runs; ++i) {
+      for (int x = runs[i].begin; x <= runs[i].end; ++x) {
+        total += row[x];
+      }
+      count += runs[i].end - runs[i].begin + 1;
+    }
+  }
+  *sum = total;
+  return count;
+}
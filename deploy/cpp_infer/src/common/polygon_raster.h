@@ -0,0 +1,126 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Scanline conversion of an integer polygon into the pixels cv::fillPoly sets
+// on a width x height image with the default arguments (8-connected outline,
+// no shift), clipping included. Rows are produced one at a time as runs, so a
+// caller can reduce over the covered pixels without filling a mask.
+//
+// Polygons of up to kInlineVertices vertices do not touch the heap.
+class PolygonRaster {
+public:
+  // Pixels begin..end of a row, both inclusive.
+  struct Run {
+    int begin;
+    int end;
+  };
+
+  static constexpr int kInlineVertices = 16;
+
+  // Point is anything with integer x and y members, e.g. cv::Point.
+  template <typename Point>
+  PolygonRaster(const Point *points, int count, int width, int height);
+
+  PolygonRaster(const PolygonRaster &) = delete;
+  PolygonRaster &operator=(const PolygonRaster &) = delete;
+
+  // Rows outside [BeginRow(), EndRow()) have no pixels.
+  int BeginRow() const { return begin_row_; }
+  int EndRow() const { return end_row_; }
+
+  // Runs of row y, sorted, disjoint and not adjacent. The pointer is valid
+  // until the next call.
+  int Row(int y, const Run **runs);
+
+  // Adds the covered values of a float map, whose row y starts at
+  // data + y * step, to *sum in row-major order and returns their number.
+  size_t Sum(const float *data, size_t step, double *sum);
+
+private:
+  // Polygon edge in 16.16 fixed point, active on rows y0 <= y < y1.
+  struct Edge {
+    int y0;
+    int y1;
+    int64_t x;
+    int64_t dx;
+  };
+  // Clipped outline segment, walked as cv::line walks it: pixel k along the
+  // major axis is offset by round(k * minor / major) along the minor one.
+  struct Line {
+    int x0;
+    int y0;
+    int major;
+    int minor;
+    int step_y;
+    bool steep;
+  };
+
+  void Reserve(int count);
+  void AddSegment(int x0, int y0, int x1, int y1);
+  void Finish();
+  bool LineRun(const Line &line, int y, Run *run) const;
+
+  int width_;
+  int height_;
+  int begin_row_ = 0;
+  int end_row_ = 0;
+  bool fill_ = false;
+
+  Edge *edges_;
+  Line *lines_;
+  int64_t *xs_;
+  Run *runs_;
+  int num_edges_ = 0;
+  int num_lines_ = 0;
+
+  Edge inline_edges_[kInlineVertices];
+  Line inline_lines_[kInlineVertices];
+  int64_t inline_xs_[kInlineVertices];
+  Run inline_runs_[2 * kInlineVertices];
+  std::vector<Edge> heap_edges_;
+  std::vector<Line> heap_lines_;
+  std::vector<int64_t> heap_xs_;
+  std::vector<Run> heap_runs_;
+};
+
+template <typename Point>
+PolygonRaster::PolygonRaster(const Point *points, int count, int width,
+                             int height)
+    : width_(width), height_(height) {
+  Reserve(count);
+  if (count <= 0 || width <= 0 || height <= 0) {
+    return;
+  }
+  int min_y = points[0].y;
+  int max_y = points[0].y;
+  const Point *prev = &points[count - 1];
+  for (int i = 0; i < count; i++) {
+    AddSegment(prev->x, prev->y, points[i].x, points[i].y);
+    min_y = points[i].y < min_y ? points[i].y : min_y;
+    max_y = points[i].y > max_y ? points[i].y : max_y;
+    prev = &points[i];
+  }
+  begin_row_ = min_y < 0 ? 0 : min_y;
+  end_row_ = max_y >= height ? height : max_y + 1;
+  if (end_row_ < begin_row_) {
+    end_row_ = begin_row_;
+  }
+  Finish();
+}
@@ -16,10 +16,14 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <numeric>
 #include <stdexcept>
 #include <unordered_map>
 
+#include "src/common/simd_kernels.h"
+#include "src/common/thread_pool.h"
+#include "src/utils/clone_counter.h"
 #include "src/utils/ilogger.h"
 #include "src/utils/utility.h"
 
@@ -120,7 +124,7 @@ absl::StatusOr<cv::Mat> Resize::ResizeOne(const cv::Mat &img) const {
     }
   }
 
-  cv::Mat out;
+  cv::Mat out = AcquireMat({cur_target[1], cur_target[0]}, img.type());
   cv::resize(img, out, cv::Size(cur_target[0], cur_target[1]), 0, 0, interp_);
   return out;
 }
@@ -169,7 +173,7 @@ absl::StatusOr<cv::Mat> ResizeByShort::ResizeOne(const cv::Mat &img) const {
                size_divisor_;
   }
 
-  cv::Mat dst;
+  cv::Mat dst = AcquireMat({h_resize, w_resize}, img.type());
   cv::resize(img, dst, cv::Size(w_resize, h_resize), 0, 0, interp_);
   return dst;
 }
@@ -198,11 +202,13 @@ ReadImage::Apply(std::vector<cv::Mat> &input, const void *param_ptr) const {
                                         " is empty.");
     }
 
-    cv::Mat converted;
+    const int out_channels = format_ == Format::GRAY ? 1 : 3;
+    cv::Mat converted = AcquireMat({img.rows, img.cols},
+                                   CV_MAKETYPE(img.depth(), out_channels));
     switch (format_) {
     case Format::BGR:
       if (img.channels() == 3) {
-        converted = img.clone();
+        img.copyTo(converted);
       } else if (img.channels() == 1) {
         cv::cvtColor(img, converted, cv::COLOR_GRAY2BGR);
       } else {
@@ -226,7 +232,7 @@ ReadImage::Apply(std::vector<cv::Mat> &input, const void *param_ptr) const {
       if (img.channels() == 3) {
         cv::cvtColor(img, converted, cv::COLOR_BGR2GRAY);
       } else if (img.channels() == 1) {
-        converted = img.clone();
+        img.copyTo(converted);
       } else {
         return absl::InvalidArgumentError("Image at index " +
                                           std::to_string(i) +
@@ -284,6 +290,33 @@ ToCHWImage::operator()(const std::vector<cv::Mat> &imgs_batch) {
   return chw_imgs;
 };
 
+// Per-channel x * alpha + beta of an 8-bit or float image into `output`, a
+// float image of the same size and channels.
+static cv::Mat NormalizeInterleavedMat(const cv::Mat &image,
+                                       const std::vector<float> &alpha,
+                                       const std::vector<float> &beta,
+                                       cv::Mat output) {
+  const int channels = image.channels();
+  int rows = image.rows;
+  size_t pixels = image.cols;
+  if (image.isContinuous() && output.isContinuous()) {
+    pixels *= rows;
+    rows = 1;
+  }
+  for (int r = 0; r < rows; ++r) {
+    if (image.depth() == CV_8U) {
+      SimdKernels::NormalizeInterleaved(image.ptr<uint8_t>(r), pixels,
+                                        channels, alpha.data(), beta.data(),
+                                        output.ptr<float>(r));
+    } else {
+      SimdKernels::NormalizeInterleaved(image.ptr<float>(r), pixels, channels,
+                                        alpha.data(), beta.data(),
+                                        output.ptr<float>(r));
+    }
+  }
+  return output;
+}
+
 Normalize::Normalize(float scale, const std::vector<float> &mean,
                      const std::vector<float> &std)
     : alpha_(CHANNEL), beta_(CHANNEL) {
@@ -311,23 +344,17 @@ absl::StatusOr<cv::Mat> Normalize::NormalizeOne(const cv::Mat &image) const {
   if (image.depth() != CV_8U && image.depth() != CV_32F) {
     return absl::InvalidArgumentError("Input image must be CV_8U or CV_32F.");
   }
-  cv::Mat input;
-  if (image.depth() == CV_8U) {
-    image.convertTo(input, CV_32F);
-  } else {
-    input = image.clone(); // note origin type is CV_8U
-  }
-  if (input.channels() == CHANNEL) {
-    cv::Mat processed = input;
-    std::vector<cv::Mat> channels(input.channels());
-    cv::split(processed, channels);
-
-    for (int c = 0; c < input.channels(); ++c) {
-      channels[c] = channels[c] * alpha_[c] + beta_[c];
-    }
-    cv::merge(channels, processed);
-    return processed;
+  if (image.channels() == CHANNEL) {
+    return NormalizeInterleavedMat(
+        image, alpha_, beta_,
+        AcquireMat({image.rows, image.cols}, CV_32FC(CHANNEL)));
   } else { // dims >= 3
+    cv::Mat input;
+    if (image.depth() == CV_8U) {
+      image.convertTo(input, CV_32F);
+    } else {
+      input = CloneCounter::Clone(image); // note origin type is CV_8U
+    }
     assert(input.isContinuous());
     int total = 1;
     for (int i = 0; i < input.dims - 1; i++) {
@@ -378,25 +405,8 @@ absl::StatusOr<cv::Mat> NormalizeImage::Normalize(const cv::Mat &img) const {
     return absl::InvalidArgumentError("Input image must be CV_8U or CV_32F.");
   }
 
-  cv::Mat input;
-  if (img.depth() == CV_8U) {
-    img.convertTo(input, CV_32F);
-  } else {
-    input = img.clone();
-  }
-
-  cv::Mat processed = input;
-
-  std::vector<cv::Mat> channels(CHANNEL);
-
-  cv::split(processed, channels);
-
-  for (int c = 0; c < CHANNEL; ++c) {
-    channels[c] = channels[c] * alpha_[c] + beta_[c];
-  }
-
-  cv::merge(channels, processed);
-  return processed;
+  return NormalizeInterleavedMat(
+      img, alpha_, beta_, AcquireMat({img.rows, img.cols}, CV_32FC(CHANNEL)));
 }
 
 absl::StatusOr<std::vector<cv::Mat>>
@@ -455,14 +465,14 @@ ToCHWImage::Apply(std::vector<cv::Mat> &input, const void *param) const {
           "Input image must have 3 channels (HWC format)!");
     }
 
-    std::vector<cv::Mat> vec_split = {};
-    cv::split(img, vec_split);
-    cv::Mat chw_img;
-    for (auto &split : vec_split)
-      split = split.reshape(1, 1);
-    cv::hconcat(vec_split, chw_img);
     std::vector<int> shape = {img.channels(), img.size[0], img.size[1]};
-    chw_img = chw_img.reshape(1, shape);
+    cv::Mat chw_img = AcquireMat(shape, img.depth());
+    // split() writes straight into the planes of chw_img.
+    std::vector<cv::Mat> planes(img.channels());
+    for (int c = 0; c < img.channels(); ++c) {
+      planes[c] = cv::Mat(img.rows, img.cols, img.depth(), chw_img.ptr(c));
+    }
+    cv::split(img, planes.data());
     chw_imgs.push_back(chw_img);
   }
 
@@ -545,11 +555,93 @@ absl::StatusOr<std::vector<cv::Mat>> ToBatch::Apply(std::vector<cv::Mat> &input,
       }
     }
   }
-  cv::Mat batch_out;
-  for (auto &image : input)
-    image = image.reshape(1, 1);
-  cv::vconcat(input, batch_out);
-  batch_out = batch_out.reshape(1, batch_shape);
+  for (const auto &image : input) {
+    if (image.type() != input[0].type()) {
+      return absl::InvalidArgumentError("All images must have the same type.");
+    }
+  }
+  cv::Mat batch_out = AcquireMat(batch_shape, input[0].type());
+  const size_t image_bytes = input[0].total() * input[0].elemSize();
+  for (size_t i = 0; i < input.size(); ++i) {
+    cv::Mat image =
+        input[i].isContinuous() ? input[i] : CloneCounter::Clone(input[i]);
+    std::memcpy(batch_out.data + i * image_bytes, image.data, image_bytes);
+  }
+  std::vector<cv::Mat> out = {batch_out};
+  return out;
+}
+
+NormalizeToBatch::NormalizeToBatch(float scale, const std::vector<float> &mean,
+                                   const std::vector<float> &std,
+                                   bool swap_rb)
+    : alpha_(CHANNEL), beta_(CHANNEL), swap_rb_(swap_rb) {
+  assert(mean.size() == CHANNEL && std.size() == CHANNEL);
+  for (size_t i = 0; i < CHANNEL; ++i) {
+    alpha_[i] = scale / std.at(i);
+    beta_[i] = -mean.at(i) / std.at(i);
+  }
+}
+
+absl::StatusOr<std::vector<cv::Mat>>
+NormalizeToBatch::Apply(std::vector<cv::Mat> &input, const void *param) const {
+  if (input.empty()) {
+    return absl::InvalidArgumentError("Input image vector is empty.");
+  }
+  const int rows = input[0].rows;
+  const int cols = input[0].cols;
+  for (size_t i = 0; i < input.size(); ++i) {
+    const cv::Mat &img = input[i];
+    if (img.empty()) {
+      return absl::InvalidArgumentError("Image at index " + std::to_string(i) +
+                                        " is empty.");
+    }
+    if (img.rows != rows || img.cols != cols) {
+      return absl::InvalidArgumentError(
+          "All images must have the same size and number of channels.");
+    }
+    if (img.channels() != CHANNEL && img.channels() != 1) {
+      return absl::InvalidArgumentError("Image at index " + std::to_string(i) +
+                                        " must have 1 or 3 channels.");
+    }
+    if (img.depth() != CV_8U && img.depth() != CV_32F) {
+      return absl::InvalidArgumentError("Input image must be CV_8U or CV_32F.");
+    }
+  }
+
+  std::vector<int> batch_shape = {(int)input.size(), CHANNEL, rows, cols};
+  cv::Mat batch_out = AcquireMat(batch_shape, CV_32F);
+  const size_t plane_size = (size_t)rows * cols;
+  for (size_t b = 0; b < input.size(); ++b) {
+    const cv::Mat &img = input[b];
+    const int src_channels = img.channels();
+    // Output channel c reads source channel src_index[c].
+    int src_index[CHANNEL] = {0, 1, 2};
+    if (src_channels == 1) {
+      src_index[1] = src_index[2] = 0;
+    } else if (swap_rb_) {
+      src_index[0] = 2;
+      src_index[2] = 0;
+    }
+    float *planes[CHANNEL];
+    for (int c = 0; c < CHANNEL; ++c) {
+      planes[c] = batch_out.ptr<float>() + (b * CHANNEL + c) * plane_size;
+    }
+    for (int r = 0; r < rows; ++r) {
+      float *dst[CHANNEL];
+      for (int c = 0; c < CHANNEL; ++c) {
+        dst[c] = planes[c] + (size_t)r * cols;
+      }
+      if (img.depth() == CV_8U) {
+        SimdKernels::NormalizeToPlanar(img.ptr<uint8_t>(r), cols, src_channels,
+                                       src_index, alpha_.data(), beta_.data(),
+                                       CHANNEL, dst);
+      } else {
+        SimdKernels::NormalizeToPlanar(img.ptr<float>(r), cols, src_channels,
+                                       src_index, alpha_.data(), beta_.data(),
+                                       CHANNEL, dst);
+      }
+    }
+  }
   std::vector<cv::Mat> out = {batch_out};
   return out;
 }
@@ -563,7 +655,7 @@ absl::StatusOr<cv::Mat> ComponentsProcessor::RotateImage(const cv::Mat &image,
     return absl::InvalidArgumentError("`angle` should be in range [0, 360)");
   }
   if (std::abs(angle) < 1e-7) {
-    return image.clone();
+    return image;
   }
 
   int h = image.rows;
@@ -587,34 +679,58 @@ absl::StatusOr<cv::Mat> ComponentsProcessor::RotateImage(const cv::Mat &image,
   return rotated;
 }
 
-std::vector<std::vector<cv::Point2f>> ComponentsProcessor::SortQuadBoxes(
+std::vector<size_t> ComponentsProcessor::SortQuadBoxes(
     const std::vector<std::vector<cv::Point2f>> &dt_polys) {
-  std::vector<std::vector<cv::Point2f>> dt_boxes = dt_polys;
-
-  std::sort(
-      dt_boxes.begin(), dt_boxes.end(),
-      [](const std::vector<cv::Point2f> &a, const std::vector<cv::Point2f> &b) {
-        return (a[0].y < b[0].y) || (a[0].y == b[0].y && a[0].x < b[0].x);
-      });
-
-  for (size_t i = 0; i < dt_boxes.size() - 1; ++i) {
-    for (size_t j = i + 1; j > 0; --j) {
-      if (std::abs(dt_boxes[j][0].y - dt_boxes[j - 1][0].y) < 10 &&
-          dt_boxes[j][0].x < dt_boxes[j - 1][0].x) {
-        std::swap(dt_boxes[j], dt_boxes[j - 1]);
-      } else {
-        break;
-      }
+  size_t num_boxes = dt_polys.size();
+  std::vector<size_t> order(num_boxes);
+  std::iota(order.begin(), order.end(), 0);
+  if (num_boxes < 2) {
+    return order;
+  }
+
+  // Boxes whose top-left corners are less than half the median box height
+  // apart in y read as one row, so the tolerance follows the text size.
+  std::vector<float> heights(num_boxes);
+  for (size_t i = 0; i < num_boxes; ++i) {
+    float top = dt_polys[i][0].y;
+    float bottom = dt_polys[i][0].y;
+    for (const auto &point : dt_polys[i]) {
+      top = std::min(top, point.y);
+      bottom = std::max(bottom, point.y);
     }
+    heights[i] = bottom - top;
   }
-  return dt_boxes;
+  std::nth_element(heights.begin(), heights.begin() + num_boxes / 2,
+                   heights.end());
+  float tolerance = 0.5f * heights[num_boxes / 2];
+
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    const cv::Point2f &pa = dt_polys[a][0];
+    const cv::Point2f &pb = dt_polys[b][0];
+    return (pa.y < pb.y) || (pa.y == pb.y && pa.x < pb.x);
+  });
+
+  // One sweep down the page: a row ends at the first box that starts a
+  // tolerance below the first box of the row, then the row is read left to
+  // right.
+  auto by_x = [&](size_t a, size_t b) {
+    return dt_polys[a][0].x < dt_polys[b][0].x;
+  };
+  size_t row_begin = 0;
+  for (size_t i = 1; i <= num_boxes; ++i) {
+    float row_y = dt_polys[order[row_begin]][0].y;
+    if (i < num_boxes && dt_polys[order[i]][0].y - row_y < tolerance) {
+      continue;
+    }
+    std::stable_sort(order.begin() + row_begin, order.begin() + i, by_x);
+    row_begin = i;
+  }
+  return order;
 }
 
-std::vector<std::vector<cv::Point2f>> ComponentsProcessor::SortPolyBoxes(
+std::vector<size_t> ComponentsProcessor::SortPolyBoxes(
     const std::vector<std::vector<cv::Point2f>> &dt_polys) {
   size_t num_boxes = dt_polys.size();
-  if (num_boxes == 0)
-    return dt_polys;
   std::vector<int> y_min_list(num_boxes);
   for (size_t i = 0; i < num_boxes; ++i) {
     int y_min = dt_polys[i][0].y;
@@ -627,13 +743,10 @@ std::vector<std::vector<cv::Point2f>> ComponentsProcessor::SortPolyBoxes(
   }
   std::vector<size_t> rank(num_boxes);
   std::iota(rank.begin(), rank.end(), 0);
-  std::sort(rank.begin(), rank.end(),
-            [&](size_t a, size_t b) { return y_min_list[a] < y_min_list[b]; });
-  std::vector<std::vector<cv::Point2f>> dt_polys_rank(num_boxes);
-  for (size_t i = 0; i < num_boxes; ++i) {
-    dt_polys_rank[i] = dt_polys[rank[i]];
-  }
-  return dt_polys_rank;
+  std::stable_sort(rank.begin(), rank.end(), [&](size_t a, size_t b) {
+    return y_min_list[a] < y_min_list[b];
+  });
+  return rank;
 }
 
 std::vector<std::array<float, 4>> ComponentsProcessor::ConvertPointsToBoxes(
@@ -663,7 +776,11 @@ std::vector<std::array<float, 4>> ComponentsProcessor::ConvertPointsToBoxes(
   return dt_boxes;
 }
 
-CropByPolys::CropByPolys(const std::string &box_type) {
+CropByPolys::CropByPolys(const std::string &box_type,
+                         float axis_aligned_epsilon, int parallel_threshold)
+    : axis_aligned_epsilon_(axis_aligned_epsilon),
+      parallel_threshold_(parallel_threshold), axis_aligned_crops_(0),
+      warped_crops_(0) {
   assert(box_type == "quad" || box_type == "poly");
   if (box_type == "quad") {
     box_type_ = DetBoxType::kQuad;
@@ -677,27 +794,36 @@ CropByPolys::operator()(const cv::Mat &img,
                         const std::vector<std::vector<cv::Point2f>> &dt_polys) {
   if (img.empty())
     return absl::InvalidArgumentError("Input image is empty.");
-  std::vector<cv::Mat> output_list;
-  try {
-    if (box_type_ == DetBoxType::kQuad) {
-      for (const auto &poly : dt_polys) {
-        auto out = GetMinAreaRectCrop(img, poly);
-        if (!out.ok())
-          return out.status();
-        output_list.push_back(*out);
-      }
-    } else if (box_type_ == DetBoxType::kPoly) {
-      for (const auto &poly : dt_polys) {
-        auto out = GetPolyRectCrop(img, poly);
-        if (!out.ok())
-          return out.status();
-        output_list.push_back(*out);
+  if (box_type_ != DetBoxType::kQuad && box_type_ != DetBoxType::kPoly)
+    return absl::UnimplementedError("Unknown box type.");
+  // Every box writes its own slot, so the order does not depend on which
+  // thread cropped it.
+  std::vector<absl::StatusOr<cv::Mat>> crops(dt_polys.size());
+  auto crop_one = [&](size_t i) {
+    try {
+      if (box_type_ == DetBoxType::kQuad) {
+        crops[i] = GetMinAreaRectCrop(img, dt_polys[i]);
+      } else {
+        crops[i] = GetPolyRectCrop(img, dt_polys[i]);
       }
-    } else {
-      return absl::UnimplementedError("Unknown box type.");
+    } catch (const std::exception &e) {
+      crops[i] = absl::InternalError(std::string("Exception: ") + e.what());
     }
-  } catch (const std::exception &e) {
-    return absl::InternalError(std::string("Exception: ") + e.what());
+  };
+  if (parallel_threshold_ > 0 &&
+      dt_polys.size() >= (size_t)parallel_threshold_) {
+    PaddlePool::parallelFor(dt_polys.size(), crop_one);
+  } else {
+    for (size_t i = 0; i < dt_polys.size(); i++) {
+      crop_one(i);
+    }
+  }
+  std::vector<cv::Mat> output_list;
+  output_list.reserve(crops.size());
+  for (auto &crop : crops) {
+    if (!crop.ok())
+      return crop.status();
+    output_list.push_back(*crop);
   }
   return output_list;
 }
@@ -724,11 +850,42 @@ CropByPolys::GetRotateCropImage(const cv::Mat &img,
   float heightRight = cv::norm(box[1] - box[2]);
   float maxHeight = std::max(heightLeft, heightRight);
 
+  cv::Size crop_size((int)maxWidth, (int)maxHeight);
+  if (IsAxisAligned(box)) {
+    cv::Rect roi(cvRound(box[0].x), cvRound(box[0].y), crop_size.width,
+                 crop_size.height);
+    if (roi.area() > 0 && (roi & cv::Rect(0, 0, img.cols, img.rows)) == roi) {
+      axis_aligned_crops_++;
+      return CropAxisAligned(img(roi));
+    }
+  }
+  warped_crops_++;
   std::vector<cv::Point2f> dst = {
       cv::Point2f(0, 0), cv::Point2f(maxWidth - 1, 0),
       cv::Point2f(maxWidth - 1, maxHeight - 1), cv::Point2f(0, maxHeight - 1)};
   cv::Mat M = cv::getPerspectiveTransform(box, dst);
   cv::Mat out;
+  if (target_size_ && crop_size.width > 0 && crop_size.height > 0) {
+    bool rotate = 1.0 * crop_size.height / crop_size.width >= 1.5;
+    cv::Size text_size =
+        rotate ? cv::Size(crop_size.height, crop_size.width) : crop_size;
+    cv::Size out_size = target_size_(text_size);
+    // Output pixels map back to the upright crop the way cv::resize samples,
+    // then through the 90 degree rotation and the perspective transform.
+    double sx = (double)text_size.width / out_size.width;
+    double sy = (double)text_size.height / out_size.height;
+    cv::Matx33d scale(sx, 0, 0.5 * sx - 0.5, 0, sy, 0.5 * sy - 0.5, 0, 0, 1);
+    cv::Matx33d unrotate = cv::Matx33d::eye();
+    if (rotate) {
+      unrotate = cv::Matx33d(0, -1, crop_size.width - 1, 1, 0, 0, 0, 0, 1);
+    }
+    cv::Matx33d perspective = M;
+    cv::Matx33d inverse = perspective.inv() * unrotate * scale;
+    int interp = sy > 1.0 ? cv::INTER_LINEAR : cv::INTER_CUBIC;
+    cv::warpPerspective(img, out, cv::Mat(inverse), out_size,
+                        interp | cv::WARP_INVERSE_MAP, cv::BORDER_REPLICATE);
+    return out;
+  }
   cv::warpPerspective(img, out, M, cv::Size((int)maxWidth, (int)maxHeight),
                       cv::INTER_CUBIC, cv::BORDER_REPLICATE);
   if (out.rows != 0 && 1.0 * out.rows / out.cols >= 1.5)
@@ -736,6 +893,56 @@ CropByPolys::GetRotateCropImage(const cv::Mat &img,
   return out;
 }
 
+bool CropByPolys::IsAxisAligned(const std::vector<cv::Point2f> &box) const {
+  if (axis_aligned_epsilon_ < 0 || box[1].x <= box[0].x ||
+      box[3].y <= box[0].y) {
+    return false;
+  }
+  return std::abs(box[0].y - box[1].y) <= axis_aligned_epsilon_ &&
+         std::abs(box[3].y - box[2].y) <= axis_aligned_epsilon_ &&
+         std::abs(box[0].x - box[3].x) <= axis_aligned_epsilon_ &&
+         std::abs(box[1].x - box[2].x) <= axis_aligned_epsilon_;
+}
+
+// Same rotation rule and target size as the warped crop, but the ROI is
+// returned as a view when neither applies.
+cv::Mat CropByPolys::CropAxisAligned(const cv::Mat &roi) const {
+  bool rotate = 1.0 * roi.rows / roi.cols >= 1.5;
+  cv::Mat out;
+  if (!target_size_) {
+    if (!rotate) {
+      return roi;
+    }
+    cv::rotate(roi, out, cv::ROTATE_90_COUNTERCLOCKWISE);
+    return out;
+  }
+  cv::Size text_size = rotate ? cv::Size(roi.rows, roi.cols) : roi.size();
+  cv::Size out_size = target_size_(text_size);
+  int interp = text_size.height > out_size.height ? cv::INTER_LINEAR
+                                                  : cv::INTER_CUBIC;
+  if (!rotate) {
+    cv::resize(roi, out, out_size, 0, 0, interp);
+    return out;
+  }
+  cv::Mat resized;
+  cv::resize(roi, resized, cv::Size(out_size.height, out_size.width), 0, 0,
+             interp);
+  cv::rotate(resized, out, cv::ROTATE_90_COUNTERCLOCKWISE);
+  return out;
+}
+
+CropByPolys::Stats CropByPolys::GetStats() const {
+  Stats stats;
+  stats.axis_aligned = axis_aligned_crops_.load();
+  stats.warped = warped_crops_.load();
+  return stats;
+}
+
+void CropByPolys::ResetStats() {
+  axis_aligned_crops_ = 0;
+  warped_crops_ = 0;
+}
+
 std::vector<cv::Point2f>
 CropByPolys::GetMinAreaRectPoints(const std::vector<cv::Point2f> &poly) const {
   auto pts = poly;
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <opencv2/opencv.hpp>
 #include <string>
@@ -133,12 +135,35 @@ public:
         const void *param = nullptr) const override;
 };
 
+// Does the work of ReadImage("RGB"), NormalizeImage, ToCHWImage and ToBatch
+// in one pass: every 8-bit or float HWC image is channel swapped, scaled and
+// written as planar floats straight into one [N, 3, H, W] batch tensor.
+class NormalizeToBatch : public BaseProcessor {
+public:
+  NormalizeToBatch(float scale = 1.0 / 255.0,
+                   const std::vector<float> &mean = {0.485, 0.456, 0.406},
+                   const std::vector<float> &std = {0.229, 0.224, 0.225},
+                   bool swap_rb = true);
+
+  absl::StatusOr<std::vector<cv::Mat>>
+  Apply(std::vector<cv::Mat> &input,
+        const void *param = nullptr) const override;
+  static constexpr int CHANNEL = 3;
+
+private:
+  std::vector<float> alpha_;
+  std::vector<float> beta_;
+  bool swap_rb_;
+};
+
 class ComponentsProcessor {
 public:
   static absl::StatusOr<cv::Mat> RotateImage(const cv::Mat &image, int angle);
-  static std::vector<std::vector<cv::Point2f>>
+  // Reading order of the boxes as indices into dt_polys. Quad boxes are
+  // grouped into text rows, read top to bottom and then left to right.
+  static std::vector<size_t>
   SortQuadBoxes(const std::vector<std::vector<cv::Point2f>> &dt_polys);
-  static std::vector<std::vector<cv::Point2f>>
+  static std::vector<size_t>
   SortPolyBoxes(const std::vector<std::vector<cv::Point2f>> &dt_polys);
   static std::vector<std::array<float, 4>>
   ConvertPointsToBoxes(const std::vector<std::vector<cv::Point2f>> &dt_polys);
@@ -148,7 +173,26 @@ class CropByPolys {
 public:
   enum class DetBoxType { kQuad, kPoly };
 
-  CropByPolys(const std::string &box_type = "quad");
+  // Number of crops cut out as plain ROIs and through a perspective warp.
+  struct Stats {
+    size_t axis_aligned = 0;
+    size_t warped = 0;
+  };
+
+  // Boxes whose edges are within axis_aligned_epsilon pixels of the image
+  // axes are cropped without a perspective warp, a negative value turns
+  // this off. Pages with at least parallel_threshold boxes are cropped on
+  // the shared thread pool.
+  CropByPolys(const std::string &box_type = "quad",
+              float axis_aligned_epsilon = 1.0,
+              int parallel_threshold = 64);
+
+  // Maps the upright size of a text line to the size it is resized to next.
+  // Once set, each crop is warped straight to that size instead of its
+  // native size, so it is resampled only once.
+  void SetTargetSize(std::function<cv::Size(const cv::Size &)> target_size) {
+    target_size_ = target_size;
+  };
 
   absl::StatusOr<std::vector<cv::Mat>>
   operator()(const cv::Mat &img,
@@ -177,6 +221,17 @@ public:
 
   static const double SCALE;
 
+  Stats GetStats() const;
+  void ResetStats();
+
 private:
+  bool IsAxisAligned(const std::vector<cv::Point2f> &box) const;
+  cv::Mat CropAxisAligned(const cv::Mat &roi) const;
+
   DetBoxType box_type_;
+  float axis_aligned_epsilon_;
+  int parallel_threshold_;
+  std::function<cv::Size(const cv::Size &)> target_size_;
+  mutable std::atomic<size_t> axis_aligned_crops_;
+  mutable std::atomic<size_t> warped_crops_;
 };
@@ -0,0 +1,635 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+// Keep x * alpha + beta as two roundings everywhere. AVX-512F carries FMA,
+// and without this GCC contracts the scalar tails and the inlined reference
+// code of the AVX-512 path into fused multiply-adds.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_KERNELS_X86 1
+#include <immintrin.h>
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace SimdKernels {
+
+namespace Scalar {
+
+void NormalizeToPlanar(const uint8_t *src, int width, int src_channels,
+                       const int *src_index, const float *alpha,
+                       const float *beta, int dst_channels,
+                       float *const *dst) {
+  for (int c = 0; c < dst_channels; ++c) {
+    const uint8_t *s = src + src_index[c];
+    float *d = dst[c];
+    const float a = alpha[c];
+    const float b = beta[c];
+    for (int x = 0; x < width; ++x) {
+      d[x] = static_cast<float>(s[x * src_channels]) * a + b;
+    }
+  }
+}
+
+void NormalizeToPlanar(const float *src, int width, int src_channels,
+                       const int *src_index, const float *alpha,
+                       const float *beta, int dst_channels,
+                       float *const *dst) {
+  for (int c = 0; c < dst_channels; ++c) {
+    const float *s = src + src_index[c];
+    float *d = dst[c];
+    const float a = alpha[c];
+    const float b = beta[c];
+    for (int x = 0; x < width; ++x) {
+      d[x] = s[x * src_channels] * a + b;
+    }
+  }
+}
+
+void NormalizeInterleaved(const uint8_t *src, size_t pixels, int channels,
+                          const float *alpha, const float *beta, float *dst) {
+  for (size_t p = 0; p < pixels; ++p) {
+    for (int c = 0; c < channels; ++c) {
+      const size_t i = p * channels + c;
+      dst[i] = static_cast<float>(src[i]) * alpha[c] + beta[c];
+    }
+  }
+}
+
+void NormalizeInterleaved(const float *src, size_t pixels, int channels,
+                          const float *alpha, const float *beta, float *dst) {
+  for (size_t p = 0; p < pixels; ++p) {
+    for (int c = 0; c < channels; ++c) {
+      const size_t i = p * channels + c;
+      dst[i] = src[i] * alpha[c] + beta[c];
+    }
+  }
+}
+
+int ArgMax(const float *data, int n, float *max_value) {
+  float max_val = data[0];
+  int max_idx = 0;
+  for (int i = 1; i < n; ++i) {
+    if (data[i] > max_val) {
+      max_val = data[i];
+      max_idx = i;
+    }
+  }
+  *max_value = max_val;
+  return max_idx;
+}
+
+} // namespace Scalar
+
+#ifdef SIMD_KERNELS_X86
+const int kMaxChannels = 4;
+
+// pshufb masks that pick byte src_offset + src_channels * k of a pixel run
+// into lane k, split by the 16-byte load the byte lives in. Loads start at
+// load_offsets[r]; lanes coming from other loads are zeroed (0x80).
+static void BuildGatherMasks(int src_offset, int src_channels, int lanes,
+                             const int *load_offsets, int loads,
+                             int8_t masks[][16]) {
+  for (int r = 0; r < loads; ++r) {
+    for (int k = 0; k < 16; ++k) {
+      masks[r][k] = static_cast<int8_t>(0x80);
+    }
+  }
+  for (int k = 0; k < lanes; ++k) {
+    const int byte = src_offset + src_channels * k;
+    for (int r = loads - 1; r >= 0; --r) {
+      if (byte >= load_offsets[r]) {
+        masks[r][k] = static_cast<int8_t>(byte - load_offsets[r]);
+        break;
+      }
+    }
+  }
+}
+
+SIMD_TARGET("avx2")
+static void NormalizeToPlanarAVX2(const uint8_t *src, int width,
+                                  int src_channels, const int *src_index,
+                                  const float *alpha, const float *beta,
+                                  int dst_channels, float *const *dst) {
+  if (src_channels != 1 && src_channels != 3) {
+    Scalar::NormalizeToPlanar(src, width, src_channels, src_index, alpha, beta,
+                              dst_channels, dst);
+    return;
+  }
+  const int vec_width = width - width % 8;
+  // 8 pixels of 3 channels are 24 bytes, covered by loads at 0 and 8.
+  const int load_offsets[2] = {0, 8};
+  for (int c = 0; c < dst_channels; ++c) {
+    const __m256 a = _mm256_set1_ps(alpha[c]);
+    const __m256 b = _mm256_set1_ps(beta[c]);
+    float *d = dst[c];
+    int x = 0;
+    if (src_channels == 1) {
+      for (; x < vec_width; x += 8) {
+        const __m128i v =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + x));
+        const __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v));
+        _mm256_storeu_ps(d + x, _mm256_add_ps(_mm256_mul_ps(f, a), b));
+      }
+    } else {
+      int8_t masks[2][16];
+      BuildGatherMasks(src_index[c], 3, 8, load_offsets, 2, masks);
+      const __m128i mask_lo =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks[0]));
+      const __m128i mask_hi =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks[1]));
+      for (; x < vec_width; x += 8) {
+        const uint8_t *p = src + x * 3;
+        const __m128i lo =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i hi =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8));
+        const __m128i v = _mm_or_si128(_mm_shuffle_epi8(lo, mask_lo),
+                                       _mm_shuffle_epi8(hi, mask_hi));
+        const __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v));
+        _mm256_storeu_ps(d + x, _mm256_add_ps(_mm256_mul_ps(f, a), b));
+      }
+    }
+    const uint8_t *s = src + src_index[c];
+    for (; x < width; ++x) {
+      d[x] = static_cast<float>(s[x * src_channels]) * alpha[c] + beta[c];
+    }
+  }
+}
+
+SIMD_TARGET("avx2")
+static void NormalizeToPlanarAVX2(const float *src, int width, int src_channels,
+                                  const int *src_index, const float *alpha,
+                                  const float *beta, int dst_channels,
+                                  float *const *dst) {
+  const int vec_width = width - width % 8;
+  const __m256i index =
+      _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                         _mm256_set1_epi32(src_channels));
+  for (int c = 0; c < dst_channels; ++c) {
+    const __m256 a = _mm256_set1_ps(alpha[c]);
+    const __m256 b = _mm256_set1_ps(beta[c]);
+    const float *s = src + src_index[c];
+    float *d = dst[c];
+    int x = 0;
+    for (; x < vec_width; x += 8) {
+      const __m256 f =
+          src_channels == 1
+              ? _mm256_loadu_ps(s + x)
+              : _mm256_i32gather_ps(s + x * src_channels, index, 4);
+      _mm256_storeu_ps(d + x, _mm256_add_ps(_mm256_mul_ps(f, a), b));
+    }
+    for (; x < width; ++x) {
+      d[x] = s[x * src_channels] * alpha[c] + beta[c];
+    }
+  }
+}
+
+SIMD_TARGET("avx512f")
+static void NormalizeToPlanarAVX512(const uint8_t *src, int width,
+                                    int src_channels, const int *src_index,
+                                    const float *alpha, const float *beta,
+                                    int dst_channels, float *const *dst) {
+  if (src_channels != 1 && src_channels != 3) {
+    Scalar::NormalizeToPlanar(src, width, src_channels, src_index, alpha, beta,
+                              dst_channels, dst);
+    return;
+  }
+  const int vec_width = width - width % 16;
+  // 16 pixels of 3 channels are 48 bytes, covered by three 16-byte loads.
+  const int load_offsets[3] = {0, 16, 32};
+  for (int c = 0; c < dst_channels; ++c) {
+    const __m512 a = _mm512_set1_ps(alpha[c]);
+    const __m512 b = _mm512_set1_ps(beta[c]);
+    float *d = dst[c];
+    int x = 0;
+    if (src_channels == 1) {
+      for (; x < vec_width; x += 16) {
+        const __m128i v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+        const __m512 f = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(v));
+        _mm512_storeu_ps(d + x, _mm512_add_ps(_mm512_mul_ps(f, a), b));
+      }
+    } else {
+      int8_t masks[3][16];
+      BuildGatherMasks(src_index[c], 3, 16, load_offsets, 3, masks);
+      __m128i mask[3];
+      for (int r = 0; r < 3; ++r) {
+        mask[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks[r]));
+      }
+      for (; x < vec_width; x += 16) {
+        const uint8_t *p = src + x * 3;
+        __m128i v = _mm_setzero_si128();
+        for (int r = 0; r < 3; ++r) {
+          const __m128i part = _mm_loadu_si128(
+              reinterpret_cast<const __m128i *>(p + load_offsets[r]));
+          v = _mm_or_si128(v, _mm_shuffle_epi8(part, mask[r]));
+        }
+        const __m512 f = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(v));
+        _mm512_storeu_ps(d + x, _mm512_add_ps(_mm512_mul_ps(f, a), b));
+      }
+    }
+    const uint8_t *s = src + src_index[c];
+    for (; x < width; ++x) {
+      d[x] = static_cast<float>(s[x * src_channels]) * alpha[c] + beta[c];
+    }
+  }
+}
+
+SIMD_TARGET("avx512f")
+static void NormalizeToPlanarAVX512(const float *src, int width,
+                                    int src_channels, const int *src_index,
+                                    const float *alpha, const float *beta,
+                                    int dst_channels, float *const *dst) {
+  const int vec_width = width - width % 16;
+  const __m512i index = _mm512_mullo_epi32(
+      _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+      _mm512_set1_epi32(src_channels));
+  for (int c = 0; c < dst_channels; ++c) {
+    const __m512 a = _mm512_set1_ps(alpha[c]);
+    const __m512 b = _mm512_set1_ps(beta[c]);
+    const float *s = src + src_index[c];
+    float *d = dst[c];
+    int x = 0;
+    for (; x < vec_width; x += 16) {
+      const __m512 f =
+          src_channels == 1
+              ? _mm512_loadu_ps(s + x)
+              : _mm512_i32gather_ps(index, s + x * src_channels, 4);
+      _mm512_storeu_ps(d + x, _mm512_add_ps(_mm512_mul_ps(f, a), b));
+    }
+    for (; x < width; ++x) {
+      d[x] = s[x * src_channels] * alpha[c] + beta[c];
+    }
+  }
+}
+
+// The per-channel coefficients repeat every `channels` elements, so
+// `channels` vectors of replicated coefficients cover lanes * channels
+// elements, i.e. exactly `lanes` pixels.
+static void ReplicateCoefficients(const float *alpha, const float *beta,
+                                  int channels, int lanes, float *alpha_rep,
+                                  float *beta_rep) {
+  for (int i = 0; i < lanes * channels; ++i) {
+    alpha_rep[i] = alpha[i % channels];
+    beta_rep[i] = beta[i % channels];
+  }
+}
+
+SIMD_TARGET("avx2")
+static void NormalizeInterleavedAVX2(const uint8_t *src, size_t pixels,
+                                     int channels, const float *alpha,
+                                     const float *beta, float *dst) {
+  float alpha_rep[8 * kMaxChannels];
+  float beta_rep[8 * kMaxChannels];
+  ReplicateCoefficients(alpha, beta, channels, 8, alpha_rep, beta_rep);
+  const size_t vec_pixels = pixels - pixels % 8;
+  for (size_t p = 0; p < vec_pixels; p += 8) {
+    const size_t base = p * channels;
+    for (int v = 0; v < channels; ++v) {
+      const __m128i u8 = _mm_loadl_epi64(
+          reinterpret_cast<const __m128i *>(src + base + v * 8));
+      const __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(u8));
+      _mm256_storeu_ps(dst + base + v * 8,
+                       _mm256_add_ps(_mm256_mul_ps(f, _mm256_loadu_ps(
+                                                          alpha_rep + v * 8)),
+                                     _mm256_loadu_ps(beta_rep + v * 8)));
+    }
+  }
+  Scalar::NormalizeInterleaved(src + vec_pixels * channels,
+                               pixels - vec_pixels, channels, alpha, beta,
+                               dst + vec_pixels * channels);
+}
+
+SIMD_TARGET("avx2")
+static void NormalizeInterleavedAVX2(const float *src, size_t pixels,
+                                     int channels, const float *alpha,
+                                     const float *beta, float *dst) {
+  float alpha_rep[8 * kMaxChannels];
+  float beta_rep[8 * kMaxChannels];
+  ReplicateCoefficients(alpha, beta, channels, 8, alpha_rep, beta_rep);
+  const size_t vec_pixels = pixels - pixels % 8;
+  for (size_t p = 0; p < vec_pixels; p += 8) {
+    const size_t base = p * channels;
+    for (int v = 0; v < channels; ++v) {
+      const __m256 f = _mm256_loadu_ps(src + base + v * 8);
+      _mm256_storeu_ps(dst + base + v * 8,
+                       _mm256_add_ps(_mm256_mul_ps(f, _mm256_loadu_ps(
+                                                          alpha_rep + v * 8)),
+                                     _mm256_loadu_ps(beta_rep + v * 8)));
+    }
+  }
+  Scalar::NormalizeInterleaved(src + vec_pixels * channels,
+                               pixels - vec_pixels, channels, alpha, beta,
+                               dst + vec_pixels * channels);
+}
+
+SIMD_TARGET("avx512f")
+static void NormalizeInterleavedAVX512(const uint8_t *src, size_t pixels,
+                                       int channels, const float *alpha,
+                                       const float *beta, float *dst) {
+  float alpha_rep[16 * kMaxChannels];
+  float beta_rep[16 * kMaxChannels];
+  ReplicateCoefficients(alpha, beta, channels, 16, alpha_rep, beta_rep);
+  const size_t vec_pixels = pixels - pixels % 16;
+  for (size_t p = 0; p < vec_pixels; p += 16) {
+    const size_t base = p * channels;
+    for (int v = 0; v < channels; ++v) {
+      const __m128i u8 = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(src + base + v * 16));
+      const __m512 f = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(u8));
+      _mm512_storeu_ps(dst + base + v * 16,
+                       _mm512_add_ps(_mm512_mul_ps(f, _mm512_loadu_ps(
+                                                          alpha_rep + v * 16)),
+                                     _mm512_loadu_ps(beta_rep + v * 16)));
+    }
+  }
+  Scalar::NormalizeInterleaved(src + vec_pixels * channels,
+                               pixels - vec_pixels, channels, alpha, beta,
+                               dst + vec_pixels * channels);
+}
+
+SIMD_TARGET("avx512f")
+static void NormalizeInterleavedAVX512(const float *src, size_t pixels,
+                                       int channels, const float *alpha,
+                                       const float *beta, float *dst) {
+  float alpha_rep[16 * kMaxChannels];
+  float beta_rep[16 * kMaxChannels];
+  ReplicateCoefficients(alpha, beta, channels, 16, alpha_rep, beta_rep);
+  const size_t vec_pixels = pixels - pixels % 16;
+  for (size_t p = 0; p < vec_pixels; p += 16) {
+    const size_t base = p * channels;
+    for (int v = 0; v < channels; ++v) {
+      const __m512 f = _mm512_loadu_ps(src + base + v * 16);
+      _mm512_storeu_ps(dst + base + v * 16,
+                       _mm512_add_ps(_mm512_mul_ps(f, _mm512_loadu_ps(
+                                                          alpha_rep + v * 16)),
+                                     _mm512_loadu_ps(beta_rep + v * 16)));
+    }
+  }
+  Scalar::NormalizeInterleaved(src + vec_pixels * channels,
+                               pixels - vec_pixels, channels, alpha, beta,
+                               dst + vec_pixels * channels);
+}
+
+// The argmax finds the largest value with independent max chains first and
+// then the first index holding it, which is the index the scalar loop picks.
+// The scalar loop never takes a NaN after the first element, so the chains
+// start at -inf and keep their own lane whenever the loaded value is NaN
+// (maxps returns its second operand if either one is unordered). A NaN in
+// the first element wins in the scalar loop and is handled up front.
+SIMD_TARGET("avx2")
+static int ArgMaxAVX2(const float *data, int n, float *max_value) {
+  if (n < 32 || data[0] != data[0]) {
+    return Scalar::ArgMax(data, n, max_value);
+  }
+  __m256 m0 = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+  __m256 m1 = m0;
+  __m256 m2 = m0;
+  __m256 m3 = m0;
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    m0 = _mm256_max_ps(_mm256_loadu_ps(data + i), m0);
+    m1 = _mm256_max_ps(_mm256_loadu_ps(data + i + 8), m1);
+    m2 = _mm256_max_ps(_mm256_loadu_ps(data + i + 16), m2);
+    m3 = _mm256_max_ps(_mm256_loadu_ps(data + i + 24), m3);
+  }
+  for (; i + 8 <= n; i += 8) {
+    m0 = _mm256_max_ps(_mm256_loadu_ps(data + i), m0);
+  }
+  m0 = _mm256_max_ps(_mm256_max_ps(m0, m1), _mm256_max_ps(m2, m3));
+  float lanes[8];
+  _mm256_storeu_ps(lanes, m0);
+  float max_val = data[0];
+  for (int k = 0; k < 8; ++k) {
+    max_val = std::max(max_val, lanes[k]);
+  }
+  // std::max keeps its first argument when the second is NaN.
+  for (; i < n; ++i) {
+    max_val = std::max(max_val, data[i]);
+  }
+  const __m256 target = _mm256_set1_ps(max_val);
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    int mask = _mm256_movemask_ps(
+        _mm256_cmp_ps(_mm256_loadu_ps(data + j), target, _CMP_EQ_OQ));
+    if (mask != 0) {
+      j += __builtin_ctz(mask);
+      *max_value = data[j];
+      return j;
+    }
+  }
+  for (; j < n; ++j) {
+    if (data[j] == max_val) {
+      *max_value = data[j];
+      return j;
+    }
+  }
+  // max_val is always one of the values, so this is not reached.
+  return Scalar::ArgMax(data, n, max_value);
+}
+
+SIMD_TARGET("avx512f")
+static int ArgMaxAVX512(const float *data, int n, float *max_value) {
+  if (n < 64 || data[0] != data[0]) {
+    return ArgMaxAVX2(data, n, max_value);
+  }
+  __m512 m0 = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+  __m512 m1 = m0;
+  __m512 m2 = m0;
+  __m512 m3 = m0;
+  int i = 0;
+  for (; i + 64 <= n; i += 64) {
+    m0 = _mm512_max_ps(_mm512_loadu_ps(data + i), m0);
+    m1 = _mm512_max_ps(_mm512_loadu_ps(data + i + 16), m1);
+    m2 = _mm512_max_ps(_mm512_loadu_ps(data + i + 32), m2);
+    m3 = _mm512_max_ps(_mm512_loadu_ps(data + i + 48), m3);
+  }
+  for (; i + 16 <= n; i += 16) {
+    m0 = _mm512_max_ps(_mm512_loadu_ps(data + i), m0);
+  }
+  m0 = _mm512_max_ps(_mm512_max_ps(m0, m1), _mm512_max_ps(m2, m3));
+  float max_val = std::max(data[0], _mm512_reduce_max_ps(m0));
+  for (; i < n; ++i) {
+    max_val = std::max(max_val, data[i]);
+  }
+  const __m512 target = _mm512_set1_ps(max_val);
+  int j = 0;
+  for (; j + 16 <= n; j += 16) {
+    __mmask16 mask =
+        _mm512_cmp_ps_mask(_mm512_loadu_ps(data + j), target, _CMP_EQ_OQ);
+    if (mask != 0) {
+      j += __builtin_ctz(mask);
+      *max_value = data[j];
+      return j;
+    }
+  }
+  for (; j < n; ++j) {
+    if (data[j] == max_val) {
+      *max_value = data[j];
+      return j;
+    }
+  }
+  return Scalar::ArgMax(data, n, max_value);
+}
+
+static Isa Detect() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return Isa::kAVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return Isa::kAVX2;
+  }
+  return Isa::kScalar;
+}
+
+#else
+static Isa Detect() { return Isa::kScalar; }
+#endif
+
+static std::atomic<int> &ActiveIsaStorage() {
+  static std::atomic<int> isa(static_cast<int>(DetectedIsa()));
+  return isa;
+}
+
+Isa DetectedIsa() {
+  static const Isa isa = Detect();
+  return isa;
+}
+
+Isa ActiveIsa() {
+  return static_cast<Isa>(ActiveIsaStorage().load(std::memory_order_relaxed));
+}
+
+Isa SetActiveIsa(Isa isa) {
+  if (static_cast<int>(isa) > static_cast<int>(DetectedIsa())) {
+    isa = DetectedIsa();
+  }
+  ActiveIsaStorage().store(static_cast<int>(isa), std::memory_order_relaxed);
+  return isa;
+}
+
+const char *IsaName(Isa isa) {
+  switch (isa) {
+  case Isa::kAVX512:
+    return "avx512";
+  case Isa::kAVX2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+void NormalizeToPlanar(const uint8_t *src, int width, int src_channels,
+                       const int *src_index, const float *alpha,
+                       const float *beta, int dst_channels,
+                       float *const *dst) {
+#ifdef SIMD_KERNELS_X86
+  switch (ActiveIsa()) {
+  case Isa::kAVX512:
+    return NormalizeToPlanarAVX512(src, width, src_channels, src_index, alpha,
+                                   beta, dst_channels, dst);
+  case Isa::kAVX2:
+    return NormalizeToPlanarAVX2(src, width, src_channels, src_index, alpha,
+                                 beta, dst_channels, dst);
+  default:
+    break;
+  }
+#endif
+  Scalar::NormalizeToPlanar(src, width, src_channels, src_index, alpha, beta,
+                            dst_channels, dst);
+}
+
+void NormalizeToPlanar(const float *src, int width, int src_channels,
+                       const int *src_index, const float *alpha,
+                       const float *beta, int dst_channels,
+                       float *const *dst) {
+#ifdef SIMD_KERNELS_X86
+  switch (ActiveIsa()) {
+  case Isa::kAVX512:
+    return NormalizeToPlanarAVX512(src, width, src_channels, src_index, alpha,
+                                   beta, dst_channels, dst);
+  case Isa::kAVX2:
+    return NormalizeToPlanarAVX2(src, width, src_channels, src_index, alpha,
+                                 beta, dst_channels, dst);
+  default:
+    break;
+  }
+#endif
+  Scalar::NormalizeToPlanar(src, width, src_channels, src_index, alpha, beta,
+                            dst_channels, dst);
+}
+
+void NormalizeInterleaved(const uint8_t *src, size_t pixels, int channels,
+                          const float *alpha, const float *beta, float *dst) {
+#ifdef SIMD_KERNELS_X86
+  if (channels <= kMaxChannels) {
+    switch (ActiveIsa()) {
+    case Isa::kAVX512:
+      return NormalizeInterleavedAVX512(src, pixels, channels, alpha, beta,
+                                        dst);
+    case Isa::kAVX2:
+      return NormalizeInterleavedAVX2(src, pixels, channels, alpha, beta, dst);
+    default:
+      break;
+    }
+  }
+#endif
+  Scalar::NormalizeInterleaved(src, pixels, channels, alpha, beta, dst);
+}
+
+void NormalizeInterleaved(const float *src, size_t pixels, int channels,
+                          const float *alpha, const float *beta, float *dst) {
+#ifdef SIMD_KERNELS_X86
+  if (channels <= kMaxChannels) {
+    switch (ActiveIsa()) {
+    case Isa::kAVX512:
+      return NormalizeInterleavedAVX512(src, pixels, channels, alpha, beta,
+                                        dst);
+    case Isa::kAVX2:
+      return NormalizeInterleavedAVX2(src, pixels, channels, alpha, beta, dst);
+    default:
+      break;
+    }
+  }
+#endif
+  Scalar::NormalizeInterleaved(src, pixels, channels, alpha, beta, dst);
+}
+
+int ArgMax(const float *data, int n, float *max_value) {
+#ifdef SIMD_KERNELS_X86
+  switch (ActiveIsa()) {
+  case Isa::kAVX512:
+    return ArgMaxAVX512(data, n, max_value);
+  case Isa::kAVX2:
+    return ArgMaxAVX2(data, n, max_value);
+  default:
+    break;
+  }
+#endif
+  return Scalar::ArgMax(data, n, max_value);
+}
+
+} // namespace SimdKernels
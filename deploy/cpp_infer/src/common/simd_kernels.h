@@ -0,0 +1,83 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Normalization and layout kernels for the preprocessors, and the argmax of
+// the recognition decoder. The widest
+// instruction set the host supports is picked once at runtime, so one binary
+// runs the AVX-512 path on AVX-512 hosts and the AVX2 path elsewhere.
+//
+// Every path computes x * alpha + beta as a separate multiply and add (no
+// FMA), which keeps the results bit-identical to the scalar reference.
+namespace SimdKernels {
+
+enum class Isa { kScalar = 0, kAVX2 = 1, kAVX512 = 2 };
+
+// The instruction set detected on this host.
+Isa DetectedIsa();
+// The instruction set the kernels dispatch to. Defaults to DetectedIsa() and
+// can be lowered with SetActiveIsa(), e.g. to compare against kScalar.
+Isa ActiveIsa();
+// Returns the instruction set actually selected, which is capped at
+// DetectedIsa().
+Isa SetActiveIsa(Isa isa);
+const char *IsaName(Isa isa);
+
+// Interleaved row of `width` pixels with `src_channels` channels to
+// `dst_channels` planes:
+//   dst[c][x] = src[x * src_channels + src_index[c]] * alpha[c] + beta[c]
+// src_index lets the caller swap or replicate channels on the way.
+void NormalizeToPlanar(const uint8_t *src, int width, int src_channels,
+                       const int *src_index, const float *alpha,
+                       const float *beta, int dst_channels,
+                       float *const *dst);
+void NormalizeToPlanar(const float *src, int width, int src_channels,
+                       const int *src_index, const float *alpha,
+                       const float *beta, int dst_channels,
+                       float *const *dst);
+
+// Interleaved to interleaved, `channels` must be at most 4:
+//   dst[i] = src[i] * alpha[i % channels] + beta[i % channels]
+// dst may alias src for float input.
+void NormalizeInterleaved(const uint8_t *src, size_t pixels, int channels,
+                          const float *alpha, const float *beta, float *dst);
+void NormalizeInterleaved(const float *src, size_t pixels, int channels,
+                          const float *alpha, const float *beta, float *dst);
+
+// Index of the first largest of the n values, which is written to
+// *max_value. n must be positive. Every path matches the scalar loop: a NaN
+// as the first value is returned, any later NaN is skipped.
+int ArgMax(const float *data, int n, float *max_value);
+
+namespace Scalar {
+void NormalizeToPlanar(const uint8_t *src, int width, int src_channels,
+                       const int *src_index, const float *alpha,
+                       const float *beta, int dst_channels,
+                       float *const *dst);
+void NormalizeToPlanar(const float *src, int width, int src_channels,
+                       const int *src_index, const float *alpha,
+                       const float *beta, int dst_channels,
+                       float *const *dst);
+void NormalizeInterleaved(const uint8_t *src, size_t pixels, int channels,
+                          const float *alpha, const float *beta, float *dst);
+void NormalizeInterleaved(const float *src, size_t pixels, int channels,
+                          const float *alpha, const float *beta, float *dst);
+int ArgMax(const float *data, int n, float *max_value);
+} // namespace Scalar
+
+} // namespace SimdKernels
@@ -0,0 +1,205 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "bounded_queue.h"
+
+// Runs items through a fixed sequence of stages. Every stage has one worker
+// thread per replica function and hands items to the next stage through a
+// BoundedQueue, so different items can be in different stages at the same
+// time. A replica function is only ever called from its own worker thread.
+// The workers start with the first Run and live until the executor is
+// destroyed; between runs they are parked on the empty queues.
+template <typename Item> class StagedExecutor {
+public:
+  using StageFunc = std::function<absl::Status(Item &)>;
+
+  explicit StagedExecutor(int queue_capacity = 4)
+      : queue_capacity_(queue_capacity) {}
+  ~StagedExecutor();
+
+  StagedExecutor(const StagedExecutor &) = delete;
+  StagedExecutor &operator=(const StagedExecutor &) = delete;
+
+  // Stages can only be added before the first Run.
+  absl::Status AddStage(const std::string &name,
+                        std::vector<StageFunc> replicas);
+
+  // Returns the processed items in input order.
+  absl::StatusOr<std::vector<Item>> Run(std::vector<Item> inputs);
+
+private:
+  struct Stage {
+    std::string name;
+    std::vector<StageFunc> replicas;
+  };
+  // Bookkeeping of one Run call, shared by all of its tasks.
+  struct RunState {
+    std::vector<Item> outputs;
+    std::atomic<bool> failed{false};
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining = 0;
+    absl::Status error = absl::OkStatus();
+  };
+  struct Task {
+    size_t index;
+    Item item;
+    RunState *run;
+  };
+  using TaskQueue = BoundedQueue<std::unique_ptr<Task>>;
+
+  void StartWorkers();
+  void WorkerLoop(size_t s, size_t r);
+
+  int queue_capacity_;
+  std::vector<Stage> stages_;
+  std::once_flag start_flag_;
+  // Set once the workers run; read outside call_once by AddStage and the
+  // destructor.
+  std::atomic<bool> started_{false};
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::unique_ptr<std::atomic<int>>> running_;
+  std::vector<std::thread> workers_;
+};
+
+template <typename Item> StagedExecutor<Item>::~StagedExecutor() {
+  if (!started_.load(std::memory_order_acquire)) {
+    return;
+  }
+  // Closing the first queue lets its workers exit, and the last worker of
+  // every stage closes the queue of the next one.
+  queues_.front()->Close();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+template <typename Item>
+absl::Status StagedExecutor<Item>::AddStage(const std::string &name,
+                                            std::vector<StageFunc> replicas) {
+  if (started_.load(std::memory_order_acquire)) {
+    return absl::FailedPreconditionError("Stage " + name +
+                                         " added after the first run.");
+  }
+  if (replicas.empty()) {
+    return absl::InvalidArgumentError("Stage " + name +
+                                      " needs at least one replica.");
+  }
+  Stage stage;
+  stage.name = name;
+  stage.replicas = std::move(replicas);
+  stages_.push_back(std::move(stage));
+  return absl::OkStatus();
+}
+
+template <typename Item> void StagedExecutor<Item>::StartWorkers() {
+  for (size_t s = 0; s < stages_.size(); s++) {
+    queues_.push_back(
+        std::unique_ptr<TaskQueue>(new TaskQueue(queue_capacity_)));
+    running_.push_back(std::unique_ptr<std::atomic<int>>(
+        new std::atomic<int>(stages_[s].replicas.size())));
+  }
+  for (size_t s = 0; s < stages_.size(); s++) {
+    for (size_t r = 0; r < stages_[s].replicas.size(); r++) {
+      workers_.emplace_back([this, s, r]() { WorkerLoop(s, r); });
+    }
+  }
+  started_.store(true, std::memory_order_release);
+}
+
+template <typename Item>
+void StagedExecutor<Item>::WorkerLoop(size_t s, size_t r) {
+  const Stage &stage = stages_[s];
+  std::unique_ptr<Task> task;
+  while (queues_[s]->Pop(task)) {
+    RunState *run = task->run;
+    // After a failure the remaining items of that run are only drained.
+    if (!run->failed.load()) {
+      absl::Status status = absl::OkStatus();
+      try {
+        status = stage.replicas[r](task->item);
+        if (!status.ok()) {
+          status = absl::Status(status.code(), stage.name + ": " +
+                                                    std::string(
+                                                        status.message()));
+        }
+      } catch (const std::exception &e) {
+        status = absl::InternalError(stage.name + ": " + e.what());
+      }
+      if (!status.ok()) {
+        std::lock_guard<std::mutex> lock(run->mutex);
+        if (run->error.ok()) {
+          run->error = status;
+        }
+        run->failed.store(true);
+      }
+    }
+    if (s + 1 < stages_.size()) {
+      queues_[s + 1]->Push(std::move(task));
+      continue;
+    }
+    run->outputs[task->index] = std::move(task->item);
+    task.reset();
+    std::lock_guard<std::mutex> lock(run->mutex);
+    if (--run->remaining == 0) {
+      run->done.notify_all();
+    }
+  }
+  if (running_[s]->fetch_sub(1) == 1 && s + 1 < stages_.size()) {
+    queues_[s + 1]->Close();
+  }
+}
+
+template <typename Item>
+absl::StatusOr<std::vector<Item>>
+StagedExecutor<Item>::Run(std::vector<Item> inputs) {
+  if (stages_.empty() || inputs.empty()) {
+    return inputs;
+  }
+  std::call_once(start_flag_, [this]() { StartWorkers(); });
+
+  RunState run;
+  run.outputs.resize(inputs.size());
+  run.remaining = inputs.size();
+  for (size_t i = 0; i < inputs.size(); i++) {
+    std::unique_ptr<Task> task(new Task());
+    task->index = i;
+    task->item = std::move(inputs[i]);
+    task->run = &run;
+    queues_[0]->Push(std::move(task));
+  }
+  {
+    std::unique_lock<std::mutex> lock(run.mutex);
+    run.done.wait(lock, [&run]() { return run.remaining == 0; });
+  }
+  if (!run.error.ok()) {
+    return run.error;
+  }
+  return std::move(run.outputs);
+}
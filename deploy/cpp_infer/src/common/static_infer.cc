@@ -14,8 +14,10 @@
 
 #include "static_infer.h"
 
+#include <algorithm>
 #include <fstream>
 
+#include "src/utils/clone_counter.h"
 #include "src/utils/ilogger.h"
 #include "src/utils/mkldnn_blocklist.h"
 #include "src/utils/utility.h"
@@ -23,9 +25,11 @@
 PaddleInfer::PaddleInfer(const std::string &model_name,
                          const std::string &model_dir,
                          const std::string &model_file_prefix,
-                         const PaddlePredictorOption &option)
+                         const PaddlePredictorOption &option,
+                         const std::vector<std::string> &output_names)
     : model_name_(model_name), model_dir_(model_dir),
-      model_file_prefix_(model_file_prefix), option_(option) {
+      model_file_prefix_(model_file_prefix), option_(option),
+      output_names_(output_names) {
   auto result = Create();
   if (!result.ok()) {
     INFOE("Create predictor failed: %s", result.status().ToString().c_str());
@@ -38,8 +42,17 @@ PaddleInfer::PaddleInfer(const std::string &model_name,
     auto handle = predictor_->GetInputHandle(name);
     input_handles_.emplace_back(std::move(handle));
   }
-  auto output_names = predictor_->GetOutputNames();
-  for (const auto &name : output_names) {
+  auto model_output_names = predictor_->GetOutputNames();
+  if (output_names_.empty() && !model_output_names.empty()) {
+    output_names_.push_back(model_output_names[0]);
+  }
+  for (const auto &name : output_names_) {
+    if (std::find(model_output_names.begin(), model_output_names.end(),
+                  name) == model_output_names.end()) {
+      INFOE("Model %s has no output named %s", model_name_.c_str(),
+            name.c_str());
+      exit(-1);
+    }
     auto handle = predictor_->GetOutputHandle(name);
     output_handles_.emplace_back(std::move(handle));
   }
@@ -133,14 +146,41 @@ absl::StatusOr<std::shared_ptr<paddle_infer::Predictor>> PaddleInfer::Create() {
 
 absl::StatusOr<std::vector<cv::Mat>>
 PaddleInfer::Apply(const std::vector<cv::Mat> &x) {
+  std::vector<cv::Mat> outputs;
+  auto status = Apply(x, outputs);
+  if (!status.ok()) {
+    return status;
+  }
+  return outputs;
+};
+
+absl::Status PaddleInfer::Apply(const std::vector<cv::Mat> &x,
+                                std::vector<cv::Mat> &outputs,
+                                bool share_outputs) {
+  if (x.size() > input_handles_.size()) {
+    return absl::InvalidArgumentError(
+        "Got " + std::to_string(x.size()) + " inputs, but the model takes " +
+        std::to_string(input_handles_.size()));
+  }
+  const bool on_cpu = option_.DeviceType() == "cpu";
+  // Kept alive until Run() returns, so a CPU predictor can read the inputs
+  // in place.
+  std::vector<cv::Mat> inputs(x.size());
   for (size_t i = 0; i < x.size(); ++i) {
+    if (x[i].depth() != CV_32F) {
+      return absl::InvalidArgumentError("Input " + std::to_string(i) +
+                                        " must be CV_32F.");
+    }
     auto &input_handle = input_handles_[i];
-    std::vector<int> input_shape(x[0].dims);
-    for (int i = 0; i < x[0].dims; i++) {
-      input_shape[i] = x[0].size[i];
+    std::vector<int> input_shape(x[i].size.p, x[i].size.p + x[i].dims);
+    inputs[i] = x[i].isContinuous() ? x[i] : CloneCounter::Clone(x[i]);
+    if (on_cpu) {
+      input_handle->ShareExternalData<float>(
+          inputs[i].ptr<float>(), input_shape, paddle_infer::PlaceType::kCPU);
+    } else {
+      input_handle->Reshape(input_shape);
+      input_handle->CopyFromCpu<float>(inputs[i].ptr<float>());
     }
-    input_handle->Reshape(input_shape);
-    input_handle->CopyFromCpu<float>((float *)x[i].data);
   }
   try {
     predictor_->Run();
@@ -149,23 +189,29 @@ PaddleInfer::Apply(const std::vector<cv::Mat> &x) {
     exit(-1);
   }
 
-  std::vector<std::vector<float>> outputs;
-  std::vector<int> output_shape = {};
-  for (auto &output_handle : output_handles_) {
-    output_shape = output_handle->shape();
-    size_t numel = 1;
-    for (auto dim : output_shape)
-      numel *= dim;
-    std::vector<float> out_data(numel);
-    output_handle->CopyToCpu(out_data.data());
-    outputs.push_back(std::move(out_data));
-  }
-  auto size_v = outputs[0].size();
-  cv::Mat pred(output_shape.size(), output_shape.data(), CV_32F);
-  memcpy(pred.ptr<float>(), outputs[0].data(),
-         outputs[0].size() * sizeof(float));
-  std::vector<cv::Mat> pred_outputs = {pred};
-  return pred_outputs;
+  outputs.resize(output_handles_.size());
+  for (size_t i = 0; i < output_handles_.size(); ++i) {
+    auto &output_handle = output_handles_[i];
+    std::vector<int> output_shape = output_handle->shape();
+    if (share_outputs && on_cpu) {
+      paddle_infer::PlaceType place;
+      int size = 0;
+      float *data = output_handle->data<float>(&place, &size);
+      if (data != nullptr && place == paddle_infer::PlaceType::kCPU) {
+        outputs[i] =
+            cv::Mat(output_shape.size(), output_shape.data(), CV_32F, data);
+        continue;
+      }
+    }
+    // create() keeps the buffer when shape and type already match, but a
+    // view from an earlier shared call must not be written through.
+    if (outputs[i].u == nullptr) {
+      outputs[i].release();
+    }
+    outputs[i].create(output_shape.size(), output_shape.data(), CV_32F);
+    output_handle->CopyToCpu(outputs[i].ptr<float>());
+  }
+  return absl::OkStatus();
 };
 
 absl::Status PaddleInfer::CheckRunMode() {
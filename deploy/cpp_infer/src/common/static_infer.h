@@ -25,13 +25,25 @@
 #include "src/utils/pp_option.h"
 class PaddleInfer {
 public:
+  // Only the outputs in `output_names` are fetched, in that order. Empty
+  // selects the first model output.
   explicit PaddleInfer(const std::string &model_name,
                        const std::string &model_dir,
                        const std::string &model_file_prefix,
-                       const PaddlePredictorOption &option);
+                       const PaddlePredictorOption &option,
+                       const std::vector<std::string> &output_names = {});
   ~PaddleInfer() = default;
   absl::StatusOr<std::vector<cv::Mat>>
   Apply(const std::vector<cv::Mat> &x); //***********
+  // Writes one Mat per selected output into `outputs`, reusing buffers that
+  // already have the right shape. With `share_outputs` on CPU the Mats are
+  // views of the predictor's output tensors instead, which stay valid only
+  // until the next call.
+  absl::Status Apply(const std::vector<cv::Mat> &x,
+                     std::vector<cv::Mat> &outputs, bool share_outputs = false);
+  const std::vector<std::string> &OutputNames() const {
+    return output_names_;
+  };
 
 private:
   std::string model_dir_;
@@ -42,6 +54,7 @@ private:
 
   std::vector<std::unique_ptr<paddle_infer::Tensor>> input_handles_;
   std::vector<std::unique_ptr<paddle_infer::Tensor>> output_handles_;
+  std::vector<std::string> output_names_;
 
   absl::StatusOr<std::shared_ptr<paddle_infer::Predictor>> Create();
 
@@ -0,0 +1,289 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "streaming_image_batch_sampler.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "image_batch_sampler.h"
+#include "src/utils/ilogger.h"
+#include "src/utils/utility.h"
+
+ImagePathWalker::ImagePathWalker(const std::vector<std::string> &inputs)
+    : inputs_(inputs) {}
+
+absl::Status ImagePathWalker::PushDirectory(const std::string &dir_path) {
+  DIR *dir = opendir(dir_path.c_str());
+  if (dir == NULL) {
+    return absl::NotFoundError("Path not found: " + dir_path);
+  }
+  Frame frame;
+  frame.dir_path = dir_path;
+  if (frame.dir_path.back() != PATH_SEPARATOR) {
+    frame.dir_path += PATH_SEPARATOR;
+  }
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    // A trailing separator on directories sorts "a.jpg" before "a/b.jpg",
+    // the same as sorting the full recursive file list.
+    if (Utility::IsDirectory(frame.dir_path + name)) {
+      name += PATH_SEPARATOR;
+    }
+    frame.entries.push_back(name);
+  }
+  closedir(dir);
+  std::sort(frame.entries.begin(), frame.entries.end());
+  stack_.push_back(std::move(frame));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> ImagePathWalker::Next(std::string &path) {
+  while (true) {
+    if (!stack_.empty()) {
+      Frame &frame = stack_.back();
+      if (frame.pos == frame.entries.size()) {
+        std::string dir_path = frame.dir_path;
+        stack_.pop_back();
+        if (stack_.empty() && root_found_ == 0) {
+          return absl::NotFoundError("No image files found in path: " +
+                                     dir_path);
+        }
+        continue;
+      }
+      const std::string &entry = frame.entries[frame.pos++];
+      if (entry.back() == PATH_SEPARATOR) {
+        auto status =
+            PushDirectory(frame.dir_path + entry.substr(0, entry.size() - 1));
+        if (!status.ok()) {
+          return status;
+        }
+      } else if (Utility::IsImageFile(entry)) {
+        path = frame.dir_path + entry;
+        root_found_++;
+        return true;
+      }
+      continue;
+    }
+    if (input_pos_ == inputs_.size()) {
+      return false;
+    }
+    const std::string &input = inputs_[input_pos_++];
+    if (Utility::IsDirectory(input)) {
+      root_found_ = 0;
+      auto status = PushDirectory(input);
+      if (!status.ok()) {
+        return status;
+      }
+    } else if (Utility::IsImageFile(input)) {
+      if (!Utility::FileExists(input).ok()) {
+        return absl::NotFoundError("File not found: " + input);
+      }
+      path = input;
+      return true;
+    } else {
+      return absl::InvalidArgumentError("Unsupported file type: " + input);
+    }
+  }
+}
+
+StreamingImageBatchSampler::StreamingImageBatchSampler(int batch_size,
+                                                       int prefetch_batches,
+                                                       int decode_threads)
+    : BaseBatchSampler(batch_size),
+      prefetch_batches_(std::max(prefetch_batches, 1)),
+      decode_threads_(std::max(decode_threads, 1)) {}
+
+StreamingImageBatchSampler::~StreamingImageBatchSampler() { Stop(); }
+
+absl::Status
+StreamingImageBatchSampler::Start(const std::vector<std::string> &inputs,
+                                  bool decode) {
+  Stop();
+  if (batch_size_ <= 0) {
+    return absl::InvalidArgumentError("Batch size must be greater than 0");
+  }
+  walker_ = std::unique_ptr<ImagePathWalker>(new ImagePathWalker(inputs));
+  decode_ = decode;
+  ready_.clear();
+  next_batch_id_ = 0;
+  next_output_id_ = 0;
+  walk_done_ = false;
+  stop_ = false;
+  try {
+    for (int i = 0; i < decode_threads_; i++) {
+      workers_.emplace_back(&StreamingImageBatchSampler::DecodeWorker, this);
+    }
+  } catch (const std::exception &e) {
+    Stop();
+    return absl::InternalError(std::string("Start decode threads failed: ") +
+                               e.what());
+  }
+  return absl::OkStatus();
+}
+
+void StreamingImageBatchSampler::DecodeWorker() {
+  while (true) {
+    size_t batch_id = 0;
+    bool walk_done = false;
+    Batch batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() {
+        return stop_ || walk_done_ ||
+               next_batch_id_ < next_output_id_ + prefetch_batches_;
+      });
+      if (stop_ || walk_done_) {
+        return;
+      }
+      std::string path;
+      while (static_cast<int>(batch.paths.size()) < batch_size_) {
+        auto has_next = walker_->Next(path);
+        if (!has_next.ok()) {
+          batch.status = has_next.status();
+          walk_done_ = true;
+          break;
+        }
+        if (!has_next.value()) {
+          walk_done_ = true;
+          break;
+        }
+        batch.paths.push_back(path);
+      }
+      if (batch.paths.empty() && batch.status.ok()) {
+        cv_.notify_all();
+        return;
+      }
+      batch_id = next_batch_id_++;
+      walk_done = walk_done_;
+    }
+    if (walk_done) {
+      cv_.notify_all();
+    }
+    for (auto &path : batch.paths) {
+      if (!decode_ || !batch.status.ok()) {
+        break;
+      }
+      if (decoder_) {
+        auto decoded = decoder_(path);
+        if (!decoded.ok()) {
+          batch.status = decoded.status();
+          break;
+        }
+        batch.images.push_back(decoded.value().image);
+        batch.full_sizes.push_back(decoded.value().full_size);
+        continue;
+      }
+      auto image = Utility::MyLoadImage(path);
+      if (!image.ok()) {
+        batch.status = image.status();
+        break;
+      }
+      batch.images.push_back(image.value());
+      batch.full_sizes.push_back(cv::Size());
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_[batch_id] = std::move(batch);
+    }
+    cv_.notify_all();
+  }
+}
+
+absl::StatusOr<bool>
+StreamingImageBatchSampler::Next(std::vector<cv::Mat> &batch,
+                                 std::vector<std::string> &batch_path,
+                                 std::vector<cv::Size> *full_sizes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() {
+    return ready_.count(next_output_id_) > 0 ||
+           (walk_done_ && next_output_id_ == next_batch_id_) || stop_;
+  });
+  auto it = ready_.find(next_output_id_);
+  if (it == ready_.end()) {
+    return false;
+  }
+  Batch item = std::move(it->second);
+  ready_.erase(it);
+  next_output_id_++;
+  lock.unlock();
+  cv_.notify_all();
+  if (!item.status.ok()) {
+    return item.status;
+  }
+  batch = std::move(item.images);
+  batch_path = std::move(item.paths);
+  if (full_sizes != nullptr) {
+    *full_sizes = std::move(item.full_sizes);
+  }
+  return true;
+}
+
+void StreamingImageBatchSampler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+absl::StatusOr<std::vector<std::vector<cv::Mat>>>
+StreamingImageBatchSampler::SampleFromString(const std::string &input) {
+  std::vector<std::string> inputs = {input};
+  return SampleFromVector(inputs);
+}
+
+absl::StatusOr<std::vector<std::vector<cv::Mat>>>
+StreamingImageBatchSampler::SampleFromVector(
+    const std::vector<std::string> &inputs) {
+  auto status = Start(inputs);
+  if (!status.ok()) {
+    return status;
+  }
+  std::vector<std::vector<cv::Mat>> results;
+  input_path_.clear();
+  std::vector<cv::Mat> batch;
+  std::vector<std::string> batch_path;
+  while (true) {
+    auto has_next = Next(batch, batch_path);
+    if (!has_next.ok()) {
+      Stop();
+      return has_next.status();
+    }
+    if (!has_next.value()) {
+      break;
+    }
+    results.push_back(batch);
+    input_path_.insert(input_path_.end(), batch_path.begin(),
+                       batch_path.end());
+  }
+  Stop();
+  return results;
+}
+
+absl::StatusOr<std::vector<std::vector<cv::Mat>>>
+StreamingImageBatchSampler::SampleFromMatVector(
+    const std::vector<cv::Mat> &inputs) {
+  return ImageBatchSampler(batch_size_).SampleFromMatVector(inputs);
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "src/base/base_batch_sampler.h"
+
+// Yields the image files of the inputs one at a time. Directories are read
+// only when the walk reaches them, in the same order as the sorted list of
+// BaseBatchSampler::GetFilesList.
+class ImagePathWalker {
+public:
+  explicit ImagePathWalker(const std::vector<std::string> &inputs);
+
+  // Returns false once all inputs were walked.
+  absl::StatusOr<bool> Next(std::string &path);
+
+private:
+  struct Frame {
+    std::string dir_path;
+    std::vector<std::string> entries;
+    size_t pos = 0;
+  };
+  absl::Status PushDirectory(const std::string &dir_path);
+
+  std::vector<std::string> inputs_;
+  size_t input_pos_ = 0;
+  std::vector<Frame> stack_;
+  size_t root_found_ = 0;
+};
+
+// Batch sampler that decodes on background threads while the caller is busy
+// with earlier batches. At most prefetch_batches decoded batches are held at
+// a time, so memory does not grow with the number of inputs.
+class StreamingImageBatchSampler : public BaseBatchSampler {
+public:
+  explicit StreamingImageBatchSampler(int batch_size = 1,
+                                      int prefetch_batches = 2,
+                                      int decode_threads = 1);
+  virtual ~StreamingImageBatchSampler();
+
+  // An image as a decoder returns it. full_size is the size of the image at
+  // full resolution if it was decoded smaller, and empty otherwise.
+  struct DecodedImage {
+    cv::Mat image;
+    cv::Size full_size;
+  };
+  using Decoder =
+      std::function<absl::StatusOr<DecodedImage>(const std::string &)>;
+
+  // Replaces Utility::MyLoadImage for decoding the images. It is called from
+  // the decode threads.
+  void SetDecoder(Decoder decoder) { decoder_ = decoder; };
+  // Without decode, Next only returns the paths of each batch.
+  absl::Status Start(const std::vector<std::string> &inputs,
+                     bool decode = true);
+  // Returns false once all batches were returned, batches come in input
+  // order. full_sizes, if given, receives the full_size of each image.
+  absl::StatusOr<bool> Next(std::vector<cv::Mat> &batch,
+                            std::vector<std::string> &batch_path,
+                            std::vector<cv::Size> *full_sizes = nullptr);
+  void Stop();
+
+  absl::StatusOr<std::vector<std::vector<cv::Mat>>>
+  SampleFromString(const std::string &input) override;
+
+  absl::StatusOr<std::vector<std::vector<cv::Mat>>>
+  SampleFromVector(const std::vector<std::string> &inputs) override;
+
+  absl::StatusOr<std::vector<std::vector<cv::Mat>>>
+  SampleFromMatVector(const std::vector<cv::Mat> &inputs) override;
+
+private:
+  struct Batch {
+    std::vector<std::string> paths;
+    std::vector<cv::Mat> images;
+    std::vector<cv::Size> full_sizes;
+    absl::Status status;
+  };
+  void DecodeWorker();
+
+  int prefetch_batches_;
+  int decode_threads_;
+  bool decode_ = true;
+  Decoder decoder_;
+  std::unique_ptr<ImagePathWalker> walker_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<size_t, Batch> ready_;
+  size_t next_batch_id_ = 0;
+  size_t next_output_id_ = 0;
+  bool walk_done_ = true;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
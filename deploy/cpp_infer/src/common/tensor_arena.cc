@@ -0,0 +1,71 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensor_arena.h"
+
+TensorArena::TensorArena(size_t max_buffers_per_shape, size_t max_shapes)
+    : max_buffers_per_shape_(max_buffers_per_shape), max_shapes_(max_shapes) {}
+
+bool TensorArena::InUse(const cv::Mat &mat) {
+  // The pool's own header holds one reference.
+  return mat.u != nullptr && CV_XADD(&mat.u->refcount, 0) > 1;
+}
+
+void TensorArena::EvictIdleShapes() {
+  for (auto it = pool_.begin(); it != pool_.end();) {
+    bool idle = true;
+    for (const auto &mat : it->second) {
+      if (InUse(mat)) {
+        idle = false;
+        break;
+      }
+    }
+    if (idle) {
+      it = pool_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+cv::Mat TensorArena::Acquire(const std::vector<int> &shape, int type) {
+  stats_.acquires++;
+  Key key(shape, type);
+  auto it = pool_.find(key);
+  if (it != pool_.end()) {
+    for (const auto &mat : it->second) {
+      if (!InUse(mat)) {
+        stats_.reuses++;
+        return mat;
+      }
+    }
+  } else if (pool_.size() >= max_shapes_) {
+    EvictIdleShapes();
+  }
+
+  cv::Mat mat(static_cast<int>(shape.size()), shape.data(), type);
+  stats_.allocations++;
+  stats_.allocated_bytes += mat.total() * mat.elemSize();
+  auto &buffers = pool_[key];
+  if (buffers.size() < max_buffers_per_shape_ && pool_.size() <= max_shapes_) {
+    buffers.push_back(mat);
+  } else if (buffers.empty()) {
+    pool_.erase(key);
+  }
+  return mat;
+}
+
+cv::Mat TensorArena::Acquire(int rows, int cols, int type) {
+  return Acquire(std::vector<int>{rows, cols}, type);
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <opencv2/opencv.hpp>
+#include <utility>
+#include <vector>
+
+// Pool of cv::Mat buffers keyed by shape and type, owned by one predictor
+// instance and used from one thread at a time. A pooled Mat is handed out
+// again once every header returned for it has been released, so steady-state
+// batches of the same shape do not touch the heap.
+class TensorArena {
+public:
+  struct Stats {
+    size_t acquires = 0;
+    size_t reuses = 0;
+    size_t allocations = 0;
+    size_t allocated_bytes = 0;
+  };
+
+  explicit TensorArena(size_t max_buffers_per_shape = 4,
+                       size_t max_shapes = 32);
+
+  // The content of the returned Mat is undefined.
+  cv::Mat Acquire(const std::vector<int> &shape, int type);
+  cv::Mat Acquire(int rows, int cols, int type);
+
+  Stats GetStats() const { return stats_; };
+  void ResetStats() { stats_ = Stats(); };
+  void Clear() { pool_.clear(); };
+
+private:
+  typedef std::pair<std::vector<int>, int> Key;
+
+  static bool InUse(const cv::Mat &mat);
+  void EvictIdleShapes();
+
+  size_t max_buffers_per_shape_;
+  size_t max_shapes_;
+  std::map<Key, std::vector<cv::Mat>> pool_;
+  Stats stats_;
+};
@@ -1,4 +1,3 @@
-
 // Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
 //
 // Licensed under the Apache License, Version 2.0 (the "License");
@@ -14,75 +13,280 @@
 // limitations under the License.
 #include "thread_pool.h"
 
+#include <algorithm>
+
+#include "src/utils/clone_counter.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace PaddlePool {
 
-constexpr size_t ThreadPool::WAIT_SECONDS;
+void ThreadPool::TaskQueue::push(Task &&task) {
+  if (size_ == tasks_.size()) {
+    std::vector<Task> tasks(tasks_.size() * 2);
+    for (size_t i = 0; i < size_; ++i) {
+      tasks[i] = std::move(tasks_[(head_ + i) % tasks_.size()]);
+    }
+    tasks_.swap(tasks);
+    head_ = 0;
+  }
+  tasks_[(head_ + size_) % tasks_.size()] = std::move(task);
+  ++size_;
+}
+
+bool ThreadPool::TaskQueue::pop(Task &task) {
+  if (size_ == 0) {
+    return false;
+  }
+  task = std::move(tasks_[head_]);
+  tasks_[head_] = nullptr;
+  head_ = (head_ + 1) % tasks_.size();
+  --size_;
+  return true;
+}
 
 ThreadPool::ThreadPool() : ThreadPool(Thread::hardware_concurrency()) {}
 
-ThreadPool::ThreadPool(size_t maxThreads)
-    : quit_(false), currentThreads_(0), idleThreads_(0),
-      maxThreads_(maxThreads) {}
+ThreadPool::ThreadPool(size_t maxThreads, size_t spinCount, bool pinThreads)
+    : quit_(false), spinCount_(spinCount), nextWorker_(0), epoch_(0),
+      parked_(0) {
+  if (maxThreads == 0) {
+    maxThreads = 1;
+  }
+  for (size_t i = 0; i < maxThreads; ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (size_t i = 0; i < maxThreads; ++i) {
+    workers_[i]->thread = Thread(&ThreadPool::worker, this, i);
+    if (pinThreads) {
+      pinThread(i);
+    }
+  }
+}
 
 ThreadPool::~ThreadPool() {
+  quit_ = true;
+  for (auto &worker : workers_) {
+    {
+      MutexGuard guard(worker->mutex);
+    }
+    worker->cv.notify_all();
+  }
+
+  for (auto &worker : workers_) {
+    assert(worker->thread.joinable());
+    worker->thread.join();
+  }
+}
+
+size_t ThreadPool::threadsNum() const { return workers_.size(); }
+
+void ThreadPool::post(Task &&task) {
+  assert(!quit_);
+  push(std::move(task));
+}
+
+void ThreadPool::push(Task &&task) {
+  // Start at the round robin position and prefer a worker that is idle.
+  size_t start = nextWorker_.fetch_add(1) % workers_.size();
+  size_t index = start;
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    size_t candidate = (start + i) % workers_.size();
+    if (workers_[candidate]->idle.load()) {
+      index = candidate;
+      break;
+    }
+  }
+  auto &worker = workers_[index];
+  bool notify = false;
   {
-    MutexGuard guard(mutex_);
-    quit_ = true;
+    MutexGuard guard(worker->mutex);
+    worker->tasks.push(std::move(task));
+    ++worker->pending;
+    notify = worker->parked;
+  }
+  ++epoch_;
+  if (notify) {
+    worker->cv.notify_one();
+  } else {
+    // The owner is busy, so hand the task to a parked worker to steal.
+    wakeParked(index);
   }
-  cv_.notify_all();
+}
+
+// A worker registers in parked_ before it checks epoch_ under its own mutex,
+// and push() bumps epoch_ before it reads parked_. One of the two sees the
+// other, and the notify is sent under the worker's mutex, so it cannot fall
+// between the check and the wait.
+void ThreadPool::wakeParked(size_t skip) {
+  if (parked_.load() == 0) {
+    return;
+  }
+  for (size_t i = 1; i <= workers_.size(); ++i) {
+    size_t candidate = (skip + i) % workers_.size();
+    if (candidate == skip) {
+      continue;
+    }
+    auto &worker = workers_[candidate];
+    bool notify = false;
+    {
+      MutexGuard guard(worker->mutex);
+      notify = worker->parked;
+    }
+    if (notify) {
+      worker->cv.notify_one();
+      return;
+    }
+  }
+}
 
-  for (auto &elem : threads_) {
-    assert(elem.second.joinable());
-    elem.second.join();
+bool ThreadPool::popTask(size_t index, Task &task) {
+  auto &worker = workers_[index];
+  if (worker->pending.load() == 0) {
+    return false;
   }
+  MutexGuard guard(worker->mutex);
+  if (!worker->tasks.pop(task)) {
+    return false;
+  }
+  --worker->pending;
+  return true;
 }
 
-size_t ThreadPool::threadsNum() const {
-  MutexGuard guard(mutex_);
-  return currentThreads_;
+// Skips a victim whose mutex is taken unless wait is set.
+bool ThreadPool::stealTask(size_t index, Task &task, bool wait) {
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    auto &victim = workers_[(index + i) % workers_.size()];
+    if (victim->pending.load() == 0) {
+      continue;
+    }
+    UniqueLock lock(victim->mutex, std::defer_lock);
+    if (wait) {
+      lock.lock();
+    } else if (!lock.try_lock()) {
+      continue;
+    }
+    if (victim->tasks.pop(task)) {
+      --victim->pending;
+      return true;
+    }
+  }
+  return false;
 }
 
-void ThreadPool::worker() {
+void ThreadPool::worker(size_t index) {
+  auto &self = workers_[index];
+  Task task;
   while (true) {
-    Task task;
-    {
-      UniqueLock uniqueLock(mutex_);
-      ++idleThreads_;
-      auto hasTimedout =
-          !cv_.wait_for(uniqueLock, std::chrono::seconds(WAIT_SECONDS),
-                        [this]() { return quit_ || !tasks_.empty(); });
-      --idleThreads_;
-      if (tasks_.empty()) {
-        if (quit_) {
-          --currentThreads_;
-          return;
-        }
-        if (hasTimedout) {
-          --currentThreads_;
-          joinFinishedThreads();
-          finishedThreadIDs_.emplace(std::this_thread::get_id());
-          return;
-        }
+    if (popTask(index, task) || stealTask(index, task, false)) {
+      self->idle = false;
+      task();
+      task = nullptr;
+      continue;
+    }
+    self->idle = true;
+    bool found = false;
+    for (size_t spin = 0; spin < spinCount_ && !quit_.load(); ++spin) {
+      if (self->pending.load() > 0) {
+        found = true;
+        break;
       }
-      task = std::move(tasks_.front());
-      tasks_.pop();
+      std::this_thread::yield();
+    }
+    if (found) {
+      continue;
+    }
+    // Last look before parking, waiting for every queue's mutex. A task it
+    // misses was queued after epoch was read, so the worker does not sleep
+    // on it, and a task it sees but loses to another thread does not wake
+    // the worker again.
+    size_t epoch = epoch_.load();
+    if (popTask(index, task) || stealTask(index, task, true)) {
+      self->idle = false;
+      task();
+      task = nullptr;
+      continue;
     }
-    task();
+    UniqueLock lock(self->mutex);
+    if (self->tasks.empty() && quit_.load()) {
+      return;
+    }
+    self->parked = true;
+    ++parked_;
+    self->cv.wait(lock, [this, &self, epoch]() {
+      return quit_.load() || !self->tasks.empty() || epoch_.load() != epoch;
+    });
+    --parked_;
+    self->parked = false;
   }
 }
 
-void ThreadPool::joinFinishedThreads() {
-  while (!finishedThreadIDs_.empty()) {
-    auto id = std::move(finishedThreadIDs_.front());
-    finishedThreadIDs_.pop();
-    auto iter = threads_.find(id);
+void ThreadPool::pinThread(size_t index) {
+#ifdef __linux__
+  size_t cpus = Thread::hardware_concurrency();
+  if (cpus == 0) {
+    return;
+  }
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(index % cpus, &cpuset);
+  pthread_setaffinity_np(workers_[index]->thread.native_handle(),
+                         sizeof(cpu_set_t), &cpuset);
+#endif
+}
 
-    assert(iter != threads_.end());
-    assert(iter->second.joinable());
+ThreadPool &sharedPool() {
+  static ThreadPool pool;
+  return pool;
+}
 
-    iter->second.join();
-    threads_.erase(iter);
+void parallelFor(size_t n, const std::function<void(size_t)> &func) {
+  if (n == 0) {
+    return;
+  }
+  static thread_local bool in_parallel_for = false;
+  if (in_parallel_for) {
+    for (size_t i = 0; i < n; ++i) {
+      func(i);
+    }
+    return;
+  }
+  std::atomic<size_t> next(0);
+  auto run = [&]() {
+    in_parallel_for = true;
+    for (size_t i = next++; i < n; i = next++) {
+      func(i);
+    }
+    in_parallel_for = false;
+  };
+  // The helpers report to the caller through the loop's own count instead
+  // of futures, so a loop allocates nothing. Each adds the bytes it cloned
+  // on its worker, and notifies under the mutex because the caller returns,
+  // destroying done, as soon as it sees running reach zero.
+  std::mutex mutex;
+  std::condition_variable done;
+  ThreadPool &pool = sharedPool();
+  size_t running = std::min(pool.threadsNum(), n) - 1;
+  size_t helper_cloned_bytes = 0;
+  auto help = [&]() {
+    size_t start = CloneCounter::ThreadBytes();
+    run();
+    ThreadPool::MutexGuard guard(mutex);
+    helper_cloned_bytes += CloneCounter::ThreadBytes() - start;
+    if (--running == 0) {
+      done.notify_one();
+    }
+  };
+  for (size_t i = running; i > 0; --i) {
+    pool.post([&help]() { help(); });
   }
+  run();
+  ThreadPool::UniqueLock lock(mutex);
+  done.wait(lock, [&running]() { return running == 0; });
+  CloneCounter::ThreadBytes() += helper_cloned_bytes;
 }
 
 } // namespace PaddlePool
@@ -13,28 +13,33 @@
 // limitations under the License.
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <condition_variable>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
-#include <unordered_map>
+#include <vector>
 
 namespace PaddlePool {
 
+// Fixed size pool. Workers are started in the constructor and live until the
+// pool is destroyed. Every worker owns a task queue that any thread may push
+// to; an idle worker steals from the others before it spins and then parks.
+// A parked worker sleeps until a task is queued anywhere in the pool after
+// its last look at the queues.
 class ThreadPool {
 public:
   using MutexGuard = std::lock_guard<std::mutex>;
   using UniqueLock = std::unique_lock<std::mutex>;
   using Thread = std::thread;
-  using ThreadID = std::thread::id;
   using Task = std::function<void()>;
 
   ThreadPool();
-  explicit ThreadPool(size_t maxThreads);
+  explicit ThreadPool(size_t maxThreads, size_t spinCount = 0,
+                      bool pinThreads = false);
 
   ThreadPool(const ThreadPool &) = delete;
   ThreadPool &operator=(const ThreadPool &) = delete;
@@ -45,25 +50,66 @@ public:
   auto submit(Func &&func, Ts &&...params)
       -> std::future<typename std::result_of<Func(Ts...)>::type>;
 
+  // Queues task without a future. Callers that count their own tasks done
+  // use it to skip the shared state submit() allocates for every task.
+  void post(Task &&task);
+
   size_t threadsNum() const;
 
 private:
-  static constexpr size_t WAIT_SECONDS = 2;
-  void worker();
-  void joinFinishedThreads();
-
-  bool quit_;
-  size_t currentThreads_;
-  size_t idleThreads_;
-  size_t maxThreads_;
-
-  mutable std::mutex mutex_;
-  std::condition_variable cv_;
-  std::queue<Task> tasks_;
-  std::queue<ThreadID> finishedThreadIDs_;
-  std::unordered_map<ThreadID, Thread> threads_;
+  // Ring buffer of tasks. Slots are reused, so a steady load does not
+  // allocate queue nodes.
+  class TaskQueue {
+  public:
+    TaskQueue() : tasks_(16), head_(0), size_(0) {}
+    bool empty() const { return size_ == 0; }
+    void push(Task &&task);
+    bool pop(Task &task);
+
+  private:
+    std::vector<Task> tasks_;
+    size_t head_;
+    size_t size_;
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::condition_variable cv;
+    TaskQueue tasks;
+    std::atomic<size_t> pending{0};
+    std::atomic<bool> idle{false};
+    bool parked = false;
+    Thread thread;
+  };
+
+  void push(Task &&task);
+  void wakeParked(size_t skip);
+  bool popTask(size_t index, Task &task);
+  bool stealTask(size_t index, Task &task, bool wait);
+  void worker(size_t index);
+  void pinThread(size_t index);
+
+  std::atomic<bool> quit_;
+  size_t spinCount_;
+  std::atomic<size_t> nextWorker_;
+  // Bumped after every task is queued, and workers parked or about to park.
+  std::atomic<size_t> epoch_;
+  std::atomic<size_t> parked_;
+  std::vector<std::unique_ptr<Worker>> workers_;
 };
 
+// Pool with one worker per hardware thread, created on first use and shared
+// by the data parallel loops of all pipeline instances.
+ThreadPool &sharedPool();
+
+// Calls func(i) for every i in [0, n) on the shared pool. The calling thread
+// takes indices too, so the loop finishes even when every worker is busy.
+// A parallelFor nested inside another runs on the calling thread alone, so
+// workers never wait on tasks queued behind them. func must not throw.
+// Bytes func clones through CloneCounter on the workers are added to the
+// calling thread's count, so a CloneCounter::Scope around the loop sees them.
+void parallelFor(size_t n, const std::function<void(size_t)> &func);
+
 } // namespace PaddlePool
 
 namespace PaddlePool {
@@ -80,18 +126,8 @@ auto ThreadPool::submit(Func &&func, Ts &&...params)
   auto task = std::make_shared<PackagedTask>(std::move(execute));
   auto result = task->get_future();
 
-  MutexGuard guard(mutex_);
   assert(!quit_);
-
-  tasks_.emplace([task]() { (*task)(); });
-  if (idleThreads_ > 0) {
-    cv_.notify_one();
-  } else if (currentThreads_ < maxThreads_) {
-    Thread t(&ThreadPool::worker, this);
-    assert(threads_.find(t.get_id()) == threads_.end());
-    threads_[t.get_id()] = std::move(t);
-    ++currentThreads_;
-  }
+  push([task]() { (*task)(); });
 
   return result;
 }
@@ -61,7 +61,7 @@ absl::StatusOr<cv::Mat> Crop::CropImage(const cv::Mat &img) const {
   }
 
   cv::Rect roi(x1, y1, crop_width, crop_height);
-  return img(roi).clone();
+  return img(roi);
 }
 
 absl::StatusOr<std::vector<cv::Mat>> Crop::Apply(std::vector<cv::Mat> &imgs,
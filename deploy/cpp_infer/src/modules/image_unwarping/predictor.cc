@@ -45,11 +45,9 @@ absl::Status WarpPredictor::Build() {
 
 std::vector<std::unique_ptr<BaseCVResult>>
 WarpPredictor::Process(std::vector<cv::Mat> &batch_data) {
-  std::vector<cv::Mat> origin_image = {};
-  origin_image.reserve(batch_data.size());
-  for (const auto &mat : batch_data) {
-    origin_image.push_back(mat.clone());
-  }
+  // No processor writes into its input, so the results can share the input
+  // buffers.
+  std::vector<cv::Mat> origin_image = batch_data;
   auto batch_read = pre_op_.at("Read")->Apply(batch_data);
   if (!batch_read.ok()) {
     INFOE(batch_read.status().ToString().c_str());
@@ -14,6 +14,8 @@
 
 #include "predictor.h"
 
+#include <map>
+
 #include "result.h"
 #include "src/common/image_batch_sampler.h"
 
@@ -32,8 +34,6 @@ TextDetPredictor::TextDetPredictor(const TextDetPredictorParams &params)
 
 absl::Status TextDetPredictor::Build() {
   const auto &pre_tfs = config_.PreProcessOpInfo();
-  // Register<ReadImage>("Read", pre_tfs.at("DecodeImage.img_mode"));
-  Register<ReadImage>("Read");
   DetResizeForTestParam resize_param;
   resize_param.input_shape = params_.input_shape;
   resize_param.max_side_limit = params_.max_side_limit;
@@ -43,9 +43,20 @@ absl::Status TextDetPredictor::Build() {
   resize_param.resize_long =
       std::stoi(pre_tfs.at("DetResizeForTest.resize_long"));
   Register<DetResizeForTest>("Resize", resize_param);
-  Register<NormalizeImage>("Normalize");
-  Register<ToCHWImage>("ToCHW");
-  Register<ToBatch>("ToBatch");
+  if (params_.bucket_sizes.has_value() &&
+      !params_.bucket_sizes.value().empty()) {
+    for (auto bucket_size : params_.bucket_sizes.value()) {
+      if (bucket_size <= 0 || bucket_size % 32 != 0) {
+        return absl::InvalidArgumentError(
+            "Detection bucket size must be a positive multiple of 32, got " +
+            std::to_string(bucket_size));
+      }
+    }
+    Register<DetPadToBucket>("Bucket", params_.bucket_sizes.value());
+  }
+  // Resizing works per channel, so the BGR to RGB swap of the former
+  // ReadImage step is done by NormalizeToBatch.
+  Register<NormalizeToBatch>("NormalizeToBatch");
   infer_ptr_ = CreateStaticInfer();
   const auto &post_params = config_.PostProcessOpInfo();
   DBPostProcessParams db_param;
@@ -64,63 +75,83 @@ absl::Status TextDetPredictor::Build() {
       std::stoi(post_params.at("PostProcess.max_candidates"));
   post_op_["DBPostProcess"] =
       std::unique_ptr<DBPostProcess>(new DBPostProcess(db_param));
+  post_op_["DBPostProcess"]->SetArena(&arena_);
   return absl::OkStatus();
 };
 
 std::vector<std::unique_ptr<BaseCVResult>>
 TextDetPredictor::Process(std::vector<cv::Mat> &batch_data) {
-  std::vector<cv::Mat> origin_image = {};
-  origin_image.reserve(batch_data.size());
-  for (const auto &mat : batch_data) {
-    origin_image.push_back(mat.clone());
-  }
-  auto batch_raw_imgs = pre_op_.at("Read")->Apply(batch_data);
-  if (!batch_raw_imgs.ok()) {
-    INFOE(batch_raw_imgs.status().ToString().c_str());
-    exit(-1);
+  // No processor writes into its input, so the results can share the input
+  // buffers.
+  std::vector<cv::Mat> origin_image = batch_data;
+  for (int i = 0; i < batch_data.size(); i++) {
+    if (batch_data[i].empty()) {
+      INFOE("Image at index %d is empty.", i);
+      exit(-1);
+    }
   }
-  std::vector<int> origin_shape = {batch_raw_imgs.value()[0].rows,
-                                   batch_raw_imgs.value()[0].cols};
-
-  auto batch_imgs = pre_op_.at("Resize")->Apply(batch_raw_imgs.value());
+  auto batch_imgs = pre_op_.at("Resize")->Apply(batch_data);
   if (!batch_imgs.ok()) {
     INFOE(batch_imgs.status().ToString().c_str());
     exit(-1);
   }
-  auto batch_imgs_normalize =
-      pre_op_.at("Normalize")->Apply(batch_imgs.value());
-  if (!batch_imgs_normalize.ok()) {
-    INFOE(batch_imgs_normalize.status().ToString().c_str());
-    exit(-1);
-  }
-
-  auto batch_imgs_to_chw =
-      pre_op_.at("ToCHW")->Apply(batch_imgs_normalize.value());
-  if (!batch_imgs_to_chw.ok()) {
-    INFOE(batch_imgs_to_chw.status().ToString().c_str());
-    exit(-1);
+  std::vector<std::vector<int>> img_shapes = {};
+  for (int i = 0; i < batch_imgs.value().size(); i++) {
+    img_shapes.push_back({batch_data[i].rows, batch_data[i].cols,
+                          batch_imgs.value()[i].rows,
+                          batch_imgs.value()[i].cols});
   }
-  auto batch_imgs_to_batch =
-      pre_op_.at("ToBatch")->Apply(batch_imgs_to_chw.value());
-  if (!batch_imgs_to_batch.ok()) {
-    INFOE(batch_imgs_to_batch.status().ToString().c_str());
-    exit(-1);
+  if (pre_op_.find("Bucket") != pre_op_.end()) {
+    batch_imgs = pre_op_.at("Bucket")->Apply(batch_imgs.value());
+    if (!batch_imgs.ok()) {
+      INFOE(batch_imgs.status().ToString().c_str());
+      exit(-1);
+    }
   }
-  auto infer_result = infer_ptr_->Apply(batch_imgs_to_batch.value());
-  if (!infer_result.ok()) {
-    INFOE(infer_result.status().ToString().c_str());
-    exit(-1);
+  // Only images of the same (bucketed) shape can share one inference call.
+  std::map<std::pair<int, int>, std::vector<int>> shape_groups;
+  for (int i = 0; i < batch_imgs.value().size(); i++) {
+    shape_groups[{batch_imgs.value()[i].rows, batch_imgs.value()[i].cols}]
+        .push_back(i);
   }
-  auto db_result = post_op_.at("DBPostProcess")
-                       ->Apply(infer_result.value()[0], origin_shape);
-
-  if (!db_result.ok()) {
-    INFOE(db_result.status().ToString().c_str());
-    exit(-1);
+  std::vector<
+      std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>>
+      db_results(batch_imgs.value().size());
+  for (auto &group : shape_groups) {
+    std::vector<cv::Mat> group_imgs = {};
+    std::vector<std::vector<int>> group_shapes = {};
+    for (auto idx : group.second) {
+      group_imgs.push_back(batch_imgs.value()[idx]);
+      group_shapes.push_back(img_shapes[idx]);
+    }
+    auto batch_imgs_to_batch =
+        pre_op_.at("NormalizeToBatch")->Apply(group_imgs);
+    if (!batch_imgs_to_batch.ok()) {
+      INFOE(batch_imgs_to_batch.status().ToString().c_str());
+      exit(-1);
+    }
+    // The probability map is a view of the predictor's output, it is only
+    // read by the post-process below.
+    std::vector<cv::Mat> infer_result;
+    auto infer_status =
+        infer_ptr_->Apply(batch_imgs_to_batch.value(), infer_result, true);
+    if (!infer_status.ok()) {
+      INFOE(infer_status.ToString().c_str());
+      exit(-1);
+    }
+    auto db_result =
+        post_op_.at("DBPostProcess")->Apply(infer_result[0], group_shapes);
+    if (!db_result.ok()) {
+      INFOE(db_result.status().ToString().c_str());
+      exit(-1);
+    }
+    for (int j = 0; j < group.second.size(); j++) {
+      db_results[group.second[j]] = std::move(db_result.value()[j]);
+    }
   }
 
   std::vector<std::unique_ptr<BaseCVResult>> base_cv_result_ptr_vec = {};
-  for (int i = 0; i < db_result.value().size(); i++, input_index_++) {
+  for (int i = 0; i < db_results.size(); i++, input_index_++) {
     TextDetPredictorResult predictor_result;
     if (!input_path_.empty()) {
       if (input_index_ == input_path_.size())
@@ -128,8 +159,8 @@ TextDetPredictor::Process(std::vector<cv::Mat> &batch_data) {
       predictor_result.input_path = input_path_[input_index_];
     }
     predictor_result.input_image = origin_image[i];
-    predictor_result.dt_polys = db_result.value()[i].first;
-    predictor_result.dt_scores = db_result.value()[i].second;
+    predictor_result.dt_polys = db_results[i].first;
+    predictor_result.dt_scores = db_results[i].second;
     predictor_result_vec_.push_back(predictor_result);
     base_cv_result_ptr_vec.push_back(
         std::unique_ptr<BaseCVResult>(new TextDetResult(predictor_result)));
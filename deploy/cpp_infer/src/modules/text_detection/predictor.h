@@ -43,6 +43,7 @@ struct TextDetPredictorParams {
   absl::optional<float> box_thresh = absl::nullopt;
   absl::optional<float> unclip_ratio = absl::nullopt;
   absl::optional<std::vector<int>> input_shape = absl::nullopt;
+  absl::optional<std::vector<int>> bucket_sizes = absl::nullopt;
 };
 
 class TextDetPredictor : public BasePredictor {
@@ -14,8 +14,11 @@
 
 #include "processors.h"
 
+#include <algorithm>
 #include <stdexcept>
 
+#include "src/common/polygon_raster.h"
+#include "src/common/thread_pool.h"
 #include "src/utils/utility.h"
 
 DetResizeForTest::DetResizeForTest(const DetResizeForTestParam &params) {
@@ -115,11 +118,11 @@ cv::Mat DetResizeForTest::ImagePadding(const cv::Mat &img, int value) const {
   return im_pad;
 }
 
-absl::StatusOr<cv::Mat>
-DetResizeForTest::ResizeImageType0(const cv::Mat &img, int limit_side_len,
-                                   const std::string &limit_type,
-                                   int max_side_limit) const {
-  int h = img.rows, w = img.cols;
+absl::StatusOr<cv::Size>
+DetResizeForTest::LimitedSize(const cv::Size &size, int limit_side_len,
+                              const std::string &limit_type,
+                              int max_side_limit) {
+  int h = size.height, w = size.width;
   float ratio = 1.f;
   if (limit_type == "max") {
     if (std::max(h, w) > limit_side_len)
@@ -143,12 +146,24 @@ DetResizeForTest::ResizeImageType0(const cv::Mat &img, int limit_side_len,
   }
   resize_h = std::max(int(std::round(resize_h / 32.0) * 32), 32);
   resize_w = std::max(int(std::round(resize_w / 32.0) * 32), 32);
+  return cv::Size(resize_w, resize_h);
+}
 
-  if (resize_h == h && resize_w == w)
+absl::StatusOr<cv::Mat>
+DetResizeForTest::ResizeImageType0(const cv::Mat &img, int limit_side_len,
+                                   const std::string &limit_type,
+                                   int max_side_limit) const {
+  auto resize_size =
+      LimitedSize(img.size(), limit_side_len, limit_type, max_side_limit);
+  if (!resize_size.ok())
+    return resize_size.status();
+  int resize_h = resize_size.value().height;
+  int resize_w = resize_size.value().width;
+  if (resize_h == img.rows && resize_w == img.cols)
     return img;
   if (resize_h <= 0 || resize_w <= 0)
     return absl::InvalidArgumentError("resize_w/h <= 0");
-  cv::Mat resized;
+  cv::Mat resized = AcquireMat({resize_h, resize_w}, img.type());
   cv::resize(img, resized, cv::Size(resize_w, resize_h));
   return resized;
 }
@@ -165,7 +180,7 @@ DetResizeForTest::ResizeImageType1(const cv::Mat &img) const {
   }
   if (resize_h == ori_h && resize_w == ori_w)
     return img;
-  cv::Mat resized;
+  cv::Mat resized = AcquireMat({resize_h, resize_w}, img.type());
   cv::resize(img, resized, cv::Size(resize_w, resize_h));
   return resized;
 }
@@ -189,7 +204,7 @@ DetResizeForTest::ResizeImageType2(const cv::Mat &img) const {
 
   if (resize_h == h && resize_w == w)
     return img;
-  cv::Mat resized;
+  cv::Mat resized = AcquireMat({resize_h, resize_w}, img.type());
   cv::resize(img, resized, cv::Size(resize_w, resize_h));
   return resized;
 }
@@ -204,11 +219,42 @@ DetResizeForTest::ResizeImageType3(const cv::Mat &img) const {
   int ori_h = img.rows, ori_w = img.cols;
   if (resize_h == ori_h && resize_w == ori_w)
     return img;
-  cv::Mat resized;
+  cv::Mat resized = AcquireMat({resize_h, resize_w}, img.type());
   cv::resize(img, resized, cv::Size(resize_w, resize_h));
   return resized;
 }
 
+DetPadToBucket::DetPadToBucket(const std::vector<int> &bucket_sizes,
+                               int value)
+    : bucket_sizes_(bucket_sizes), value_(value) {
+  std::sort(bucket_sizes_.begin(), bucket_sizes_.end());
+}
+
+absl::StatusOr<std::vector<cv::Mat>>
+DetPadToBucket::Apply(std::vector<cv::Mat> &input,
+                      const void *param_ptr) const {
+  std::vector<cv::Mat> results;
+  results.reserve(input.size());
+  for (const auto &img : input) {
+    int pad_h = BucketSize(img.rows);
+    int pad_w = BucketSize(img.cols);
+    if (pad_h == img.rows && pad_w == img.cols) {
+      results.push_back(img);
+      continue;
+    }
+    cv::Mat padded = AcquireMat({pad_h, pad_w}, img.type());
+    cv::copyMakeBorder(img, padded, 0, pad_h - img.rows, 0, pad_w - img.cols,
+                       cv::BORDER_CONSTANT, cv::Scalar::all(value_));
+    results.push_back(padded);
+  }
+  return results;
+}
+
+int DetPadToBucket::BucketSize(int size) const {
+  auto it = std::lower_bound(bucket_sizes_.begin(), bucket_sizes_.end(), size);
+  return it == bucket_sizes_.end() ? size : *it;
+}
+
 DBPostProcess::DBPostProcess(const DBPostProcessParams &params)
     : thresh_(params.thresh.value_or(0.3)),
       box_thresh_(params.box_thresh.value_or(0.7)),
@@ -236,7 +282,8 @@ DBPostProcess::operator()(const cv::Mat &preds,
   for (const auto &preds_data : *preds_batch) {
     auto result = Process(preds_data, img_shapes, thresh.value_or(thresh_),
                           box_thresh.value_or(box_thresh_),
-                          unclip_ratio.value_or(unclip_ratio_));
+                          unclip_ratio.value_or(unclip_ratio_),
+                          AcquireMaps(preds_data));
 
     if (!result.ok()) {
       return result.status();
@@ -270,7 +317,8 @@ DBPostProcess::Apply(const cv::Mat &preds, const std::vector<int> &img_shapes,
   for (const auto &pred : preds_batch.value()) {
     auto result = Process(pred, img_shapes, thresh.value_or(thresh_),
                           box_thresh.value_or(box_thresh_),
-                          unclip_ratio.value_or(unclip_ratio_));
+                          unclip_ratio.value_or(unclip_ratio_),
+                          AcquireMaps(pred));
 
     if (!result.ok()) {
       return result.status();
@@ -281,18 +329,140 @@ DBPostProcess::Apply(const cv::Mat &preds, const std::vector<int> &img_shapes,
   return db_result;
 }
 
+absl::StatusOr<std::vector<
+    std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>>>
+DBPostProcess::Apply(const cv::Mat &preds,
+                     const std::vector<std::vector<int>> &img_shapes,
+                     absl::optional<float> thresh,
+                     absl::optional<float> box_thresh,
+                     absl::optional<float> unclip_ratio) {
+  auto preds_batch = Utility::SplitBatch(preds);
+  if (!preds_batch.ok()) {
+    return preds_batch.status();
+  }
+  if (preds_batch.value().size() != img_shapes.size()) {
+    return absl::InvalidArgumentError(
+        "Number of image shapes (" + std::to_string(img_shapes.size()) +
+        ") does not match batch size (" +
+        std::to_string(preds_batch.value().size()) + ")");
+  }
+  // The maps of every page are taken before the pages run, in page order, so
+  // the arena sees the same requests however the pool schedules the pages,
+  // and a batch of a shape seen before allocates nothing.
+  std::vector<PageMaps> maps;
+  maps.reserve(preds_batch.value().size());
+  for (const auto &pred : preds_batch.value()) {
+    maps.push_back(AcquireMaps(pred));
+  }
+  // Batch items are independent, each writes its own slot.
+  std::vector<absl::StatusOr<
+      std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>>>
+      results(preds_batch.value().size());
+  auto process_item = [&](size_t i) {
+    results[i] =
+        Process(preds_batch.value()[i], img_shapes[i], thresh.value_or(thresh_),
+                box_thresh.value_or(box_thresh_),
+                unclip_ratio.value_or(unclip_ratio_), maps[i]);
+  };
+  if (results.size() > 1) {
+    PaddlePool::parallelFor(results.size(), process_item);
+  } else {
+    for (size_t i = 0; i < results.size(); i++) {
+      process_item(i);
+    }
+  }
+  std::vector<
+      std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>>
+      db_result = {};
+  db_result.reserve(results.size());
+  for (auto &result : results) {
+    if (!result.ok()) {
+      return result.status();
+    }
+    db_result.push_back(std::move(result.value()));
+  }
+  return db_result;
+}
+
+DBPostProcess::PageMaps DBPostProcess::AcquireMaps(const cv::Mat &pred) {
+  int rows = pred.size[pred.dims - 2];
+  int cols = pred.size[pred.dims - 1];
+  PageMaps maps;
+  maps.segmentation = AcquireMap(rows, cols);
+  if (use_dilation_) {
+    maps.mask = AcquireMap(rows, cols);
+  }
+  return maps;
+}
+
+cv::Mat DBPostProcess::AcquireMap(int rows, int cols) {
+  if (arena_ == nullptr) {
+    return cv::Mat(rows, cols, CV_8UC1);
+  }
+  return arena_->Acquire(rows, cols, CV_8UC1);
+}
+
+// Corners of box ordered top-left, top-right, bottom-right, bottom-left,
+// with the length of its shorter side.
+static std::pair<std::vector<cv::Point2f>, float>
+MiniBoxPoints(const cv::RotatedRect &box) {
+  std::vector<cv::Point2f> points(4);
+  box.points(points.data());
+
+  std::sort(
+      points.begin(), points.end(),
+      [](const cv::Point2f &a, const cv::Point2f &b) { return a.x < b.x; });
+
+  int index_1 = 0, index_2 = 1, index_3 = 2, index_4 = 3;
+  if (points[1].y > points[0].y) {
+    index_1 = 0;
+    index_4 = 1;
+  } else {
+    index_1 = 1;
+    index_4 = 0;
+  }
+
+  if (points[3].y > points[2].y) {
+    index_2 = 2;
+    index_3 = 3;
+  } else {
+    index_2 = 3;
+    index_3 = 2;
+  }
+
+  std::vector<cv::Point2f> box_points = {points[index_1], points[index_2],
+                                         points[index_3], points[index_4]};
+
+  float sside = std::min(box.size.width, box.size.height);
+  return std::make_pair(box_points, sside);
+}
+
 absl::StatusOr<
     std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>>
 DBPostProcess::Process(const cv::Mat &pred, const std::vector<int> &img_shape,
-                       float thresh, float box_thresh, float unclip_ratio) {
-  cv::Mat pred_single = pred.clone();
-  std::vector<int> shape_pred = {pred_single.size[pred_single.dims - 2],
-                                 pred_single.size[pred_single.dims - 1]};
-  pred_single = pred_single.reshape(1, shape_pred);
-  cv::Mat segmentation = pred_single > thresh;
+                       float thresh, float box_thresh, float unclip_ratio,
+                       const PageMaps &maps) {
+  // The prediction is only read, a view of the predictor output does.
+  std::vector<int> shape_pred = {pred.size[pred.dims - 2],
+                                 pred.size[pred.dims - 1]};
+  cv::Mat pred_single = pred.reshape(1, shape_pred);
+  if (img_shape.size() == 4) {
+    if (img_shape[2] > pred_single.rows || img_shape[3] > pred_single.cols) {
+      return absl::InvalidArgumentError(
+          "Valid region exceeds the prediction map.");
+    }
+    pred_single = pred_single(cv::Rect(0, 0, img_shape[3], img_shape[2]));
+  }
+  // The maps are taken at the size of the whole prediction map, which stays
+  // the same across pages, so the arena hands the same buffers out again;
+  // only the valid region is used.
+  cv::Rect valid(0, 0, pred_single.cols, pred_single.rows);
+  cv::Mat segmentation = maps.segmentation(valid);
+  cv::compare(pred_single, thresh, segmentation, cv::CMP_GT);
   cv::Mat mask;
   if (use_dilation_) {
     cv::Mat kernel = (cv::Mat_<uchar>(2, 2) << 1, 1, 1, 1); //暂时未测试
+    mask = maps.mask(valid);
     cv::dilate(segmentation, mask, kernel);
   } else {
     mask = segmentation;
@@ -394,37 +564,29 @@ absl::StatusOr<
 DBPostProcess::BoxesFromBitmap(const cv::Mat &pred, const cv::Mat &bitmap,
                                int dest_width, int dest_height,
                                float box_thresh, float unclip_ratio) {
-  std::vector<std::vector<cv::Point2f>> boxes;
-  std::vector<float> scores;
-
   float width_scale = static_cast<float>(dest_width) / bitmap.cols;
   float height_scale = static_cast<float>(dest_height) / bitmap.rows;
 
-  cv::Mat bitmap_uint8;
-  bitmap.convertTo(bitmap_uint8, CV_8UC1, 255.0);
-
-  std::vector<std::vector<cv::Point>> contours_;
-  cv::findContours(bitmap_uint8, contours_, cv::RETR_LIST,
-                   cv::CHAIN_APPROX_SIMPLE);
-  std::vector<std::vector<cv::Point2f>> contours;
-  for (const auto &contour : contours_) { // 这里可以优化
-    std::vector<cv::Point2f> float_contour;
-    for (const auto &point : contour) {
-      float_contour.push_back(cv::Point2f(point.x, point.y));
-    }
-    contours.push_back(float_contour);
-  }
+  // The bitmap is already 0/255, findContours takes it as it is.
+  std::vector<std::vector<cv::Point>> contours;
+  cv::findContours(bitmap, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
   int num_contours =
       std::min(static_cast<int>(contours.size()), max_candidates_);
 
-  for (int i = 0; i < num_contours; ++i) {
+  // Every contour fills its own slot, so the kept boxes come out in contour
+  // order however the work was split.
+  std::vector<std::vector<cv::Point2f>> candidate_boxes(num_contours);
+  std::vector<float> candidate_scores(num_contours, 0.0f);
+  std::vector<char> kept(num_contours, 0);
+  auto process_contour = [&](size_t i) {
     const auto &contour = contours[i];
 
-    auto contour_result = GetMiniBoxes(contour);
-    auto points = contour_result.first;
+    cv::RotatedRect rect = cv::minAreaRect(contour);
+    auto contour_result = MiniBoxPoints(rect);
+    auto &points = contour_result.first;
     auto sside = contour_result.second;
     if (sside < min_size_) {
-      continue;
+      return;
     }
 
     float score = 0;
@@ -435,20 +597,14 @@ DBPostProcess::BoxesFromBitmap(const cv::Mat &pred, const cv::Mat &bitmap,
     }
 
     if (box_thresh > score) {
-      continue;
-    }
-
-    auto unclip_result = Unclip(points, unclip_ratio);
-    if (!unclip_result.ok()) {
-      continue;
+      return;
     }
 
-    auto box = *unclip_result;
-    auto min_box_result = GetMiniBoxes(box);
-    auto min_box = min_box_result.first;
+    auto min_box_result = MiniBoxPoints(UnclipRect(rect, unclip_ratio));
+    auto &min_box = min_box_result.first;
     auto new_sside = min_box_result.second;
     if (new_sside < min_size_ + 2) {
-      continue;
+      return;
     }
 
     for (auto &point : min_box) {
@@ -460,8 +616,25 @@ DBPostProcess::BoxesFromBitmap(const cv::Mat &pred, const cv::Mat &bitmap,
                       dest_height - 1));
     }
 
-    boxes.push_back(min_box);
-    scores.push_back(score);
+    candidate_boxes[i] = std::move(min_box);
+    candidate_scores[i] = score;
+    kept[i] = 1;
+  };
+  if (num_contours >= PARALLEL_CONTOURS) {
+    PaddlePool::parallelFor(num_contours, process_contour);
+  } else {
+    for (int i = 0; i < num_contours; ++i) {
+      process_contour(i);
+    }
+  }
+
+  std::vector<std::vector<cv::Point2f>> boxes;
+  std::vector<float> scores;
+  for (int i = 0; i < num_contours; ++i) {
+    if (kept[i]) {
+      boxes.push_back(std::move(candidate_boxes[i]));
+      scores.push_back(candidate_scores[i]);
+    }
   }
 
   return std::make_pair(boxes, scores);
@@ -496,156 +669,82 @@ DBPostProcess::Unclip(const std::vector<cv::Point2f> &box, float unclip_ratio) {
   return result;
 }
 
-std::pair<std::vector<cv::Point2f>, float>
-DBPostProcess::GetMiniBoxes(const std::vector<cv::Point2f> &contour) {
-  cv::RotatedRect box = cv::minAreaRect(contour);
-
-  std::vector<cv::Point2f> points(4);
-  box.points(points.data());
+cv::RotatedRect DBPostProcess::UnclipRect(const cv::RotatedRect &box,
+                                          float unclip_ratio) {
+  // Offsetting a rectangle with round joins moves every side out by the
+  // distance, so the min-area rectangle of the Clipper result is the box
+  // grown by twice the distance, up to Clipper's integer rounding.
+  float width = box.size.width;
+  float height = box.size.height;
+  float length = 2.0f * (width + height);
+  if (length <= 0.0f) {
+    return box;
+  }
+  float distance = width * height * unclip_ratio / length;
+  return cv::RotatedRect(
+      box.center, cv::Size2f(width + 2 * distance, height + 2 * distance),
+      box.angle);
+}
 
-  std::sort(
-      points.begin(), points.end(),
-      [](const cv::Point2f &a, const cv::Point2f &b) { return a.x < b.x; });
+std::pair<std::vector<cv::Point2f>, float>
+DBPostProcess::GetMiniBoxes(cv::InputArray contour) {
+  return MiniBoxPoints(cv::minAreaRect(contour));
+}
 
-  int index_1 = 0, index_2 = 1, index_3 = 2, index_4 = 3;
-  if (points[1].y > points[0].y) {
-    index_1 = 0;
-    index_4 = 1;
-  } else {
-    index_1 = 1;
-    index_4 = 0;
+// Mean of bitmap over the contour as cv::fillPoly rasterizes it. The covered
+// pixels come from a scanline fill and are summed in place, in the order
+// cv::mean visits them under a mask, and the sum is scaled by the reciprocal
+// of the count as cv::mean does, so the score is the one of the masked mean
+// without filling a mask.
+template <typename Point>
+static float PolygonMean(const cv::Mat &bitmap,
+                         const std::vector<Point> &contour) {
+  if (contour.empty()) {
+    return 0.0f;
   }
-
-  if (points[3].y > points[2].y) {
-    index_2 = 2;
-    index_3 = 3;
-  } else {
-    index_2 = 3;
-    index_3 = 2;
+  int h = bitmap.size[bitmap.dims - 2]; // must be CHW
+  int w = bitmap.size[bitmap.dims - 1];
+  float min_x = contour[0].x, max_x = contour[0].x;
+  float min_y = contour[0].y, max_y = contour[0].y;
+  for (const auto &point : contour) {
+    min_x = std::min(min_x, static_cast<float>(point.x));
+    max_x = std::max(max_x, static_cast<float>(point.x));
+    min_y = std::min(min_y, static_cast<float>(point.y));
+    max_y = std::max(max_y, static_cast<float>(point.y));
+  }
+  int xmin = std::min(std::max(0, static_cast<int>(std::floor(min_x))), w - 1);
+  int xmax = std::min(std::max(0, static_cast<int>(std::ceil(max_x))), w - 1);
+  int ymin = std::min(std::max(0, static_cast<int>(std::floor(min_y))), h - 1);
+  int ymax = std::min(std::max(0, static_cast<int>(std::ceil(max_y))), h - 1);
+  int roi_w = xmax - xmin + 1;
+  int roi_h = ymax - ymin + 1;
+
+  int npts = static_cast<int>(contour.size());
+  cv::Point inline_points[PolygonRaster::kInlineVertices];
+  std::vector<cv::Point> heap_points;
+  cv::Point *points = inline_points;
+  if (npts > PolygonRaster::kInlineVertices) {
+    heap_points.resize(npts);
+    points = heap_points.data();
+  }
+  for (int i = 0; i < npts; ++i) {
+    points[i] = cv::Point(static_cast<int>(contour[i].x - xmin),
+                          static_cast<int>(contour[i].y - ymin));
   }
 
-  std::vector<cv::Point2f> box_points = {points[index_1], points[index_2],
-                                         points[index_3], points[index_4]};
-
-  float sside = std::min(box.size.width, box.size.height);
-  return std::make_pair(box_points, sside);
+  PolygonRaster raster(points, npts, roi_w, roi_h);
+  double sum = 0.0;
+  size_t count =
+      raster.Sum(bitmap.ptr<float>(ymin) + xmin, bitmap.step1(0), &sum);
+  return count > 0 ? static_cast<float>(sum * (1.0 / count)) : 0.0f;
 }
 
 float DBPostProcess::BoxScoreFast(const cv::Mat &bitmap,
                                   const std::vector<cv::Point2f> &contour) {
-  int h = bitmap.size[bitmap.dims - 2]; // must be CHW
-  int w = bitmap.size[bitmap.dims - 1];
-
-  std::vector<cv::Point2f> contour_copy = contour;
-
-  int xmin = std::max(
-      0, static_cast<int>(std::floor(
-             std::min_element(contour_copy.begin(), contour_copy.end(),
-                              [](const cv::Point2f &a, const cv::Point2f &b) {
-                                return a.x < b.x;
-                              })
-                 ->x)));
-  int xmax = std::max(
-      0, static_cast<int>(std::ceil(
-             std::max_element(contour_copy.begin(), contour_copy.end(),
-                              [](const cv::Point2f &a, const cv::Point2f &b) {
-                                return a.x < b.x;
-                              })
-                 ->x)));
-  int ymin = std::max(
-      0, static_cast<int>(std::floor(
-             std::min_element(contour_copy.begin(), contour_copy.end(),
-                              [](const cv::Point2f &a, const cv::Point2f &b) {
-                                return a.y < b.y;
-                              })
-                 ->y)));
-  int ymax = std::max(
-      0, static_cast<int>(std::ceil(
-             std::max_element(contour_copy.begin(), contour_copy.end(),
-                              [](const cv::Point2f &a, const cv::Point2f &b) {
-                                return a.y < b.y;
-                              })
-                 ->y)));
-
-  xmin = std::min(xmin, w - 1);
-  xmax = std::min(xmax, w - 1);
-  ymin = std::min(ymin, h - 1);
-  ymax = std::min(ymax, h - 1);
-
-  cv::Mat mask = cv::Mat::zeros(ymax - ymin + 1, xmax - xmin + 1, CV_8UC1);
-
-  std::vector<cv::Point> contour_copy_int;
-  for (auto &point : contour_copy) {
-    point.x -= xmin;
-    point.y -= ymin;
-    contour_copy_int.push_back(
-        cv::Point(static_cast<int>(point.x), static_cast<int>(point.y)));
-  }
-
-  std::vector<std::vector<cv::Point>> contours = {contour_copy_int};
-  cv::fillPoly(mask, contours, cv::Scalar(1));
-
-  cv::Mat roi = bitmap(cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1));
-  cv::Scalar mean_val = cv::mean(roi, mask);
-
-  return mean_val[0];
+  return PolygonMean(bitmap, contour);
 }
 
 float DBPostProcess::BoxScoreSlow(const cv::Mat &bitmap,
-                                  const std::vector<cv::Point2f> &contour) {
-  int h = bitmap.size[bitmap.dims - 2]; // must be CHW
-  int w = bitmap.size[bitmap.dims - 1];
-
-  std::vector<cv::Point2f> contour_copy = contour;
-
-  int xmin = std::max(
-      0, static_cast<int>(std::floor(
-             std::min_element(contour_copy.begin(), contour_copy.end(),
-                              [](const cv::Point2f &a, const cv::Point2f &b) {
-                                return a.x < b.x;
-                              })
-                 ->x)));
-  int xmax = std::max(
-      0, static_cast<int>(std::ceil(
-             std::max_element(contour_copy.begin(), contour_copy.end(),
-                              [](const cv::Point2f &a, const cv::Point2f &b) {
-                                return a.x < b.x;
-                              })
-                 ->x)));
-  int ymin = std::max(
-      0, static_cast<int>(std::floor(
-             std::min_element(contour_copy.begin(), contour_copy.end(),
-                              [](const cv::Point2f &a, const cv::Point2f &b) {
-                                return a.y < b.y;
-                              })
-                 ->y)));
-  int ymax = std::max(
-      0, static_cast<int>(std::ceil(
-             std::max_element(contour_copy.begin(), contour_copy.end(),
-                              [](const cv::Point2f &a, const cv::Point2f &b) {
-                                return a.y < b.y;
-                              })
-                 ->y)));
-
-  xmin = std::min(xmin, w - 1);
-  xmax = std::min(xmax, w - 1);
-  ymin = std::min(ymin, h - 1);
-  ymax = std::min(ymax, h - 1);
-
-  cv::Mat mask = cv::Mat::zeros(ymax - ymin + 1, xmax - xmin + 1, CV_8UC1);
-
-  std::vector<cv::Point> contour_copy_int;
-  for (auto &point : contour_copy) {
-    point.x -= xmin;
-    point.y -= ymin;
-    contour_copy_int.push_back(
-        cv::Point(static_cast<int>(point.x), static_cast<int>(point.y)));
-  }
-
-  std::vector<std::vector<cv::Point>> contours = {contour_copy_int};
-  cv::fillPoly(mask, contours, 1);
-
-  cv::Scalar mean = cv::mean(
-      bitmap(cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1)), mask);
-  return static_cast<float>(mean[0]);
+                                  const std::vector<cv::Point> &contour) {
+  return PolygonMean(bitmap, contour);
 }
@@ -41,6 +41,12 @@ public:
   absl::StatusOr<std::vector<cv::Mat>>
   Apply(std::vector<cv::Mat> &input,
         const void *param_ptr = nullptr) const override;
+  // Size an image of the given size is resized to by the limit_side_len
+  // resize.
+  static absl::StatusOr<cv::Size> LimitedSize(const cv::Size &size,
+                                              int limit_side_len,
+                                              const std::string &limit_type,
+                                              int max_side_limit);
 
 private:
   int resize_type_ = 0;
@@ -68,6 +74,20 @@ private:
   static constexpr int INPUTSHAPE = 3;
 };
 
+class DetPadToBucket : public BaseProcessor {
+public:
+  DetPadToBucket(const std::vector<int> &bucket_sizes, int value = 0);
+  absl::StatusOr<std::vector<cv::Mat>>
+  Apply(std::vector<cv::Mat> &input,
+        const void *param_ptr = nullptr) const override;
+
+private:
+  int BucketSize(int size) const;
+
+  std::vector<int> bucket_sizes_;
+  int value_;
+};
+
 struct DBPostProcessParams {
   absl::optional<float> thresh = absl::nullopt;
   absl::optional<float> box_thresh = absl::nullopt;
@@ -94,12 +114,38 @@ public:
         absl::optional<float> thresh = absl::nullopt,
         absl::optional<float> box_thresh = absl::nullopt,
         absl::optional<float> unclip_ratio = absl::nullopt);
+  // One shape per batch item: {src_h, src_w} or {src_h, src_w, valid_h,
+  // valid_w} when the input was padded and only the top-left valid_h x
+  // valid_w region of the prediction belongs to the image.
+  absl::StatusOr<std::vector<
+      std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>>>
+  Apply(const cv::Mat &preds, const std::vector<std::vector<int>> &img_shapes,
+        absl::optional<float> thresh = absl::nullopt,
+        absl::optional<float> box_thresh = absl::nullopt,
+        absl::optional<float> unclip_ratio = absl::nullopt);
+
+  // Set by the owning predictor, the binarized maps are then reused from its
+  // arena instead of being allocated per page.
+  void SetArena(TensorArena *arena) { arena_ = arena; };
 
 private:
+  friend class DBPostProcessTestPeer;
+
+  // The 8-bit maps one page is binarized into, as large as the prediction
+  // map. The mask is only taken with dilation.
+  struct PageMaps {
+    cv::Mat segmentation;
+    cv::Mat mask;
+  };
+
+  // Takes the maps from the arena, from the thread that calls Apply.
+  PageMaps AcquireMaps(const cv::Mat &pred);
+  cv::Mat AcquireMap(int rows, int cols);
+
   absl::StatusOr<
       std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>>
   Process(const cv::Mat &pred, const std::vector<int> &img_shape, float thresh,
-          float box_thresh, float unclip_ratio);
+          float box_thresh, float unclip_ratio, const PageMaps &maps);
 
   absl::StatusOr<
       std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>>
@@ -114,14 +160,24 @@ private:
   absl::StatusOr<std::vector<cv::Point2f>>
   Unclip(const std::vector<cv::Point2f> &box, float unclip_ratio);
 
+  // Analytic Unclip of a rectangle, for the quad boxes: the box grown by the
+  // offset distance on every side, which is the min-area rectangle of the
+  // ClipperOffset result up to Clipper's integer rounding.
+  static cv::RotatedRect UnclipRect(const cv::RotatedRect &box,
+                                    float unclip_ratio);
+
   std::pair<std::vector<cv::Point2f>, float>
-  GetMiniBoxes(const std::vector<cv::Point2f> &contour);
+  GetMiniBoxes(cv::InputArray contour);
 
   float BoxScoreFast(const cv::Mat &bitmap,
                      const std::vector<cv::Point2f> &contour);
 
   float BoxScoreSlow(const cv::Mat &bitmap,
-                     const std::vector<cv::Point2f> &contour);
+                     const std::vector<cv::Point> &contour);
+
+  // Pages with at least this many contours score and unclip them on the
+  // shared thread pool.
+  static constexpr int PARALLEL_CONTOURS = 64;
 
 private:
   float thresh_;
@@ -132,4 +188,5 @@ private:
   bool use_dilation_;
   std::string score_mode_;
   std::string box_type_;
+  TensorArena *arena_ = nullptr;
 };
@@ -49,11 +49,9 @@ absl::Status TextRecPredictor::Build() {
 
 std::vector<std::unique_ptr<BaseCVResult>>
 TextRecPredictor::Process(std::vector<cv::Mat> &batch_data) {
-  std::vector<cv::Mat> origin_image = {};
-  origin_image.reserve(batch_data.size());
-  for (const auto &mat : batch_data) {
-    origin_image.push_back(mat.clone());
-  }
+  // No processor writes into its input, so the results can share the input
+  // buffers.
+  std::vector<cv::Mat> origin_image = batch_data;
   auto batch_read = pre_op_.at("Read")->Apply(batch_data);
   if (!batch_read.ok()) {
     INFOE(batch_read.status().ToString().c_str());
@@ -71,14 +69,15 @@ TextRecPredictor::Process(std::vector<cv::Mat> &batch_data) {
     INFOE(batch_tobatch.status().ToString().c_str());
     exit(-1);
   }
-  auto batch_infer = infer_ptr_->Apply(batch_tobatch.value());
-  if (!batch_infer.ok()) {
-    INFOE(batch_infer.status().ToString().c_str());
+  std::vector<cv::Mat> batch_infer;
+  auto infer_status =
+      infer_ptr_->Apply(batch_tobatch.value(), batch_infer, true);
+  if (!infer_status.ok()) {
+    INFOE(infer_status.ToString().c_str());
     exit(-1);
   }
 
-  auto ctc_result =
-      post_op_.at("CTCLabelDecode")->Apply(batch_infer.value()[0]);
+  auto ctc_result = post_op_.at("CTCLabelDecode")->Apply(batch_infer[0]);
 
   if (!ctc_result.ok()) {
     INFOE(ctc_result.status().ToString().c_str());
@@ -14,13 +14,49 @@
 
 #include "processors.h"
 
-#include <numeric>
 #include <sstream>
 #include <stdexcept>
-#include <unordered_map>
 
+#include "src/common/simd_kernels.h"
+#include "src/common/thread_pool.h"
 #include "src/utils/utility.h"
 
+// Normalizes (x / 255 - 0.5) / 0.5 as one multiply-add and writes the
+// dst_c channels as planes of width dst_w, zero padded past image.cols.
+static absl::Status NormalizeRecImage(const cv::Mat &image, int dst_c,
+                                      int dst_w, float *dst) {
+  const int channels = image.channels();
+  if (channels != dst_c || channels > 4 || image.cols > dst_w) {
+    return absl::InvalidArgumentError("Unsupported recognition image shape.");
+  }
+  if (image.depth() != CV_8U && image.depth() != CV_32F) {
+    return absl::InvalidArgumentError("Input image must be CV_8U or CV_32F.");
+  }
+  int src_index[4] = {0, 1, 2, 3};
+  const float alpha[4] = {2.0f / 255.0f, 2.0f / 255.0f, 2.0f / 255.0f,
+                          2.0f / 255.0f};
+  const float beta[4] = {-1.0f, -1.0f, -1.0f, -1.0f};
+  const size_t plane_size = (size_t)image.rows * dst_w;
+  float *planes[4];
+  for (int r = 0; r < image.rows; ++r) {
+    for (int c = 0; c < channels; ++c) {
+      planes[c] = dst + c * plane_size + (size_t)r * dst_w;
+    }
+    if (image.depth() == CV_8U) {
+      SimdKernels::NormalizeToPlanar(image.ptr<uint8_t>(r), image.cols,
+                                     channels, src_index, alpha, beta,
+                                     channels, planes);
+    } else {
+      SimdKernels::NormalizeToPlanar(image.ptr<float>(r), image.cols, channels,
+                                     src_index, alpha, beta, channels, planes);
+    }
+    for (int c = 0; c < channels; ++c) {
+      std::fill(planes[c] + image.cols, planes[c] + dst_w, 0.0f);
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::vector<cv::Mat>>
 OCRReisizeNormImg::Apply(std::vector<cv::Mat> &input, const void *param) const {
   std::vector<cv::Mat> output = {};
@@ -56,25 +92,35 @@ absl::StatusOr<cv::Mat> OCRReisizeNormImg::Resize(cv::Mat &image) const {
   return image_result.value();
 }
 
+cv::Size OCRReisizeNormImg::ResizedSize(const cv::Size &image_size) const {
+  if (!input_shape_.empty()) {
+    return cv::Size(input_shape_[2], input_shape_[1]);
+  }
+  int rec_h = rec_image_shape_[1];
+  float rec_wh_ratio = (float)rec_image_shape_[2] / (float)rec_h;
+  float wh_ratio = (float)image_size.width / (float)image_size.height;
+  int rec_w = rec_h * std::max(rec_wh_ratio, wh_ratio);
+  if (rec_w > MAX_IMG_W) {
+    return cv::Size(MAX_IMG_W, rec_h);
+  }
+  return cv::Size(std::min((int)std::ceil(rec_h * wh_ratio), rec_w), rec_h);
+}
+
 absl::StatusOr<cv::Mat> OCRReisizeNormImg::StaticResize(cv::Mat &image) const {
-  cv::Mat resize_image;
   int img_c = input_shape_[0];
   int img_h = input_shape_[1];
   int img_w = input_shape_[2];
-  cv::resize(image, resize_image, cv::Size(img_w, img_h));
-  resize_image.convertTo(resize_image, CV_32F);
-  std::vector<cv::Mat> mat_split(resize_image.channels());
-  cv::split(resize_image, mat_split);
-  for (auto &item : mat_split) {
-    item /= 255;
-    item -= 0.5;
-    item /= 0.5;
-    item = item.reshape(1, 1);
+  cv::Mat resize_image = image;
+  if (image.rows != img_h || image.cols != img_w) {
+    resize_image = AcquireMat({img_h, img_w}, image.type());
+    cv::resize(image, resize_image, cv::Size(img_w, img_h));
+  }
+  cv::Mat resize_image_process = AcquireMat({img_c, img_h, img_w}, CV_32F);
+  auto status = NormalizeRecImage(resize_image, img_c, img_w,
+                                  resize_image_process.ptr<float>());
+  if (!status.ok()) {
+    return status;
   }
-  cv::Mat resize_image_process;
-  cv::hconcat(mat_split, resize_image_process);
-  std::vector<int> resize_shape = {img_c, img_h, img_w};
-  resize_image_process = resize_image_process.reshape(1, resize_shape);
   return resize_image_process;
 }
 
@@ -86,12 +132,10 @@ OCRReisizeNormImg::ResizeNormImg(cv::Mat &image, float max_wh_ratio) const {
   int rec_w = rec_image_shape_[2];
 
   rec_w = rec_h * max_wh_ratio;
-  cv::Mat resize_image;
   int resize_w = 0;
   if (rec_w > MAX_IMG_W) {
     rec_w = MAX_IMG_W;
     resize_w = MAX_IMG_W;
-    cv::resize(image, resize_image, cv::Size(resize_w, rec_h));
   } else {
     float wh_ratio = (float)image.size[1] / (float)image.size[0];
     if (std::ceil(rec_h * wh_ratio) > rec_w) {
@@ -99,30 +143,18 @@ OCRReisizeNormImg::ResizeNormImg(cv::Mat &image, float max_wh_ratio) const {
     } else {
       resize_w = std::ceil(rec_h * wh_ratio);
     }
-    cv::resize(image, resize_image, cv::Size(resize_w, rec_h));
   }
-  resize_image.convertTo(resize_image, CV_32F);
-  std::vector<cv::Mat> mat_split(resize_image.channels());
-  cv::split(resize_image, mat_split);
-  for (auto &item : mat_split) {
-    item /= 255;
-    item -= 0.5;
-    item /= 0.5;
-    item = item.reshape(1, 1);
+  // Crops warped straight to the recognition height are used as they are.
+  cv::Mat resize_image = image;
+  if (image.rows != rec_h || image.cols > rec_w) {
+    resize_image = AcquireMat({rec_h, resize_w}, image.type());
+    cv::resize(image, resize_image, cv::Size(resize_w, rec_h));
   }
-  cv::Mat resize_image_process;
-  cv::hconcat(mat_split, resize_image_process);
-  std::vector<int> resize_shape = {rec_c, rec_h, resize_w};
-  resize_image_process = resize_image_process.reshape(1, resize_shape);
-  std::vector<int> image_shape = {rec_c, rec_h, rec_w};
-  cv::Mat padding_im =
-      cv::Mat::zeros(image_shape.size(), &image_shape[0], CV_32F);
-  for (int c = 0; c < rec_c; ++c) {
-    for (int row = 0; row < rec_h; ++row) {
-      float *dst = padding_im.ptr<float>(c) + row * rec_w;
-      float *src = resize_image_process.ptr<float>(c) + row * resize_w;
-      std::copy(src, src + resize_w, dst);
-    }
+  cv::Mat padding_im = AcquireMat({rec_c, rec_h, rec_w}, CV_32F);
+  auto status =
+      NormalizeRecImage(resize_image, rec_c, rec_w, padding_im.ptr<float>());
+  if (!status.ok()) {
+    return status;
   }
   return padding_im;
 }
@@ -140,126 +172,89 @@ CTCLabelDecode::CTCLabelDecode(const std::vector<std::string> &character_list,
     character_list_.emplace_back(std::string(" "));
   }
   AddSpecialChar();
-  dict_.reserve(character_list_.size());
-  for (int i = 0; i < character_list_.size(); i++) {
-    dict_[i] = character_list_[i];
+  char_offsets_.reserve(character_list_.size() + 1);
+  char_offsets_.push_back(0);
+  for (const auto &character : character_list_) {
+    char_table_ += character;
+    char_offsets_.push_back(char_table_.size());
   }
 }
 
 absl::StatusOr<std::vector<std::pair<std::string, float>>>
 CTCLabelDecode::Apply(const cv::Mat &preds) const {
-  auto preds_batch = Utility::SplitBatch(preds);
-  std::vector<std::pair<std::string, float>> ctc_result = {};
-  ctc_result.reserve(preds_batch.value().size());
-  if (!preds_batch.ok()) {
-    return preds_batch.status();
+  if (preds.type() != CV_32F || preds.dims != 3 || !preds.isContinuous()) {
+    return absl::InvalidArgumentError(
+        "CTC input must be a continuous CV_32F tensor of shape [N, T, C].");
   }
-  for (const auto &pred : preds_batch.value()) {
-    auto result = Process(pred);
-    if (!result.ok()) {
-      return result.status();
+  int batch_size = preds.size[0];
+  int seq_len = preds.size[1];
+  int num_classes = preds.size[2];
+  if (num_classes <= 0) {
+    return absl::InvalidArgumentError("CTC input has no classes.");
+  }
+  std::vector<std::pair<std::string, float>> ctc_result(batch_size);
+  const float *data = preds.ptr<float>();
+  const size_t row_size = (size_t)seq_len * num_classes;
+  auto decode_row = [&](size_t i) {
+    ctc_result[i].second = DecodeSequence(data + i * row_size, seq_len,
+                                          num_classes, ctc_result[i].first);
+  };
+  if (batch_size >= PARALLEL_BATCH) {
+    PaddlePool::parallelFor(batch_size, decode_row);
+  } else {
+    for (int i = 0; i < batch_size; ++i) {
+      decode_row(i);
     }
-    ctc_result.push_back(result.value());
   }
   return ctc_result;
 }
 
 absl::StatusOr<std::pair<std::string, float>>
 CTCLabelDecode::Process(const cv::Mat &pred_data) const {
-  std::vector<int> shape_squeeze = {};
-  for (int i = 1; i < pred_data.dims; i++) {
-    shape_squeeze.push_back(pred_data.size[i]);
+  if (pred_data.type() != CV_32F || pred_data.dims < 2 ||
+      !pred_data.isContinuous()) {
+    return absl::InvalidArgumentError(
+        "CTC input must be a continuous CV_32F tensor.");
   }
-  cv::Mat pred_data_process;
-  pred_data_process = pred_data.reshape(1, shape_squeeze);
-
-  int seq_len = pred_data_process.size[0];
-  int num_classes = pred_data_process.size[1];
-  std::list<int> text_index;
-  std::list<float> text_prob;
-  for (int t = 0; t < seq_len; ++t) {
-    const float *row_ptr = pred_data_process.ptr<float>(t);
-    float max_val = row_ptr[0];
-    int max_idx = 0;
-    for (int c = 1; c < num_classes; ++c) {
-      if (row_ptr[c] > max_val) {
-        max_val = row_ptr[c];
-        max_idx = c;
-      }
-    }
-    text_index.push_back(max_idx);
-    text_prob.push_back(max_val);
-  }
-  auto decode_result = Decode(text_index, text_prob, true);
-  if (!decode_result.ok()) {
-    return decode_result.status();
+  int seq_len = pred_data.size[pred_data.dims - 2];
+  int num_classes = pred_data.size[pred_data.dims - 1];
+  if (num_classes <= 0) {
+    return absl::InvalidArgumentError("CTC input has no classes.");
   }
-  return decode_result.value();
+  std::pair<std::string, float> result;
+  result.second = DecodeSequence(pred_data.ptr<float>(), seq_len, num_classes,
+                                 result.first);
+  return result;
 }
 
-absl::StatusOr<std::pair<std::string, float>>
-CTCLabelDecode::Decode(std::list<int> &text_index, std::list<float> &text_prob,
-                       bool is_remove_duplicate) const {
-  std::vector<bool> selection(text_index.size(), true);
-  if (is_remove_duplicate && text_index.size() > 1) {
-    auto prev = text_index.begin();
-    auto curr = std::next(prev);
-    size_t idx = 1;
-    for (; curr != text_index.end(); ++curr, ++prev, ++idx) {
-      if (*curr == *prev)
-        selection[idx] = false;
-    }
-  }
-  for (const auto &ignore_item : IGNORE_TOKEN) {
-    size_t idx = 0;
-    for (auto item_list = text_index.begin(); item_list != text_index.end();
-         ++item_list, idx++) {
-      if (*item_list == ignore_item) {
-        selection[idx] = false;
-      }
-    }
-  }
-  auto sel_it = selection.begin();
-  for (auto it = text_index.begin(); it != text_index.end();) {
-    if (!(*sel_it)) {
-      it = text_index.erase(it);
-    } else {
-      ++it;
-    }
-    ++sel_it;
-  }
-  auto sel_it_prob = selection.begin();
-  for (auto it = text_prob.begin(); it != text_prob.end();) {
-    if (!(*sel_it_prob)) {
-      it = text_prob.erase(it);
-    } else {
-      ++it;
+float CTCLabelDecode::DecodeSequence(const float *pred, int seq_len,
+                                     int num_classes,
+                                     std::string &text) const {
+  text.clear();
+  float score_sum = 0.0f;
+  int kept = 0;
+  int prev_idx = -1;
+  for (int t = 0; t < seq_len; ++t) {
+    float prob = 0.0f;
+    int idx = SimdKernels::ArgMax(pred + (size_t)t * num_classes, num_classes,
+                                  &prob);
+    bool keep = idx != prev_idx &&
+                std::find(IGNORE_TOKEN.begin(), IGNORE_TOKEN.end(), idx) ==
+                    IGNORE_TOKEN.end();
+    prev_idx = idx;
+    if (!keep) {
+      continue;
     }
-    ++sel_it_prob;
-  }
-  std::vector<std::string> char_list = {};
-  for (auto list_index = text_index.begin(); list_index != text_index.end();
-       ++list_index) {
-    if ((*list_index) < character_list_.size()) {
-      char_list.push_back(character_list_[*list_index]);
+    if ((size_t)idx + 1 < char_offsets_.size()) {
+      text.append(char_table_, char_offsets_[idx],
+                  char_offsets_[idx + 1] - char_offsets_[idx]);
     } else {
-      char_list.push_back(" ");
+      text.push_back(' ');
     }
+    score_sum += prob;
+    kept++;
   }
-  std::list<float> conf_list = {};
-  if (!text_prob.empty()) {
-    conf_list = text_prob;
-  } else {
-    conf_list = std::list<float>(selection.size(), 0);
-  }
-  std::string text;
-  for (const auto &item_char : char_list) {
-    text += item_char;
-  }
-  float sum = std::accumulate(conf_list.begin(), conf_list.end(), 0.0f);
-  float mean = sum / conf_list.size();
-
-  return std::pair<std::string, float>(text, mean);
+  return kept > 0 ? score_sum / kept : 0.0f;
 }
 
 void CTCLabelDecode::AddSpecialChar() {
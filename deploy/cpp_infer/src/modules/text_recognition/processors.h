@@ -15,6 +15,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "src/common/processors.h"
+#include "src/utils/clone_counter.h"
 #include "src/utils/func_register.h"
 
 class OCRReisizeNormImg : public BaseProcessor {
@@ -38,6 +40,8 @@ public:
   absl::StatusOr<cv::Mat> StaticResize(cv::Mat &image) const;
   absl::StatusOr<cv::Mat> ResizeNormImg(cv::Mat &image,
                                         float max_wh_ratio) const;
+  // Size an image of the given size is resized to before normalization.
+  cv::Size ResizedSize(const cv::Size &image_size) const;
   static constexpr int MAX_IMG_W = 3200;
 
 private:
@@ -49,19 +53,27 @@ class CTCLabelDecode {
 public:
   CTCLabelDecode(const std::vector<std::string> &character_list = {},
                  bool use_space_char = true);
+  // Decodes every row of an [N, T, C] tensor, large batches in parallel.
   absl::StatusOr<std::vector<std::pair<std::string, float>>>
   Apply(const cv::Mat &preds) const;
   absl::StatusOr<std::pair<std::string, float>>
   Process(const cv::Mat &pred_data) const;
-  absl::StatusOr<std::pair<std::string, float>>
-  Decode(std::list<int> &text_index, std::list<float> &text_prob,
-         bool is_remove_duplicate = false) const;
   void AddSpecialChar();
+  static constexpr int PARALLEL_BATCH = 4;
 
 private:
+  // Greedy decode of seq_len steps: takes the argmax of every step, drops
+  // repeats and ignored tokens in the same pass and returns the mean score of
+  // the kept steps.
+  float DecodeSequence(const float *pred, int seq_len, int num_classes,
+                       std::string &text) const;
+
   std::vector<std::string> character_list_;
   bool use_space_char_;
-  std::unordered_map<int, std::string> dict_;
+  // The UTF-8 of all characters back to back, character i takes bytes
+  // [char_offsets_[i], char_offsets_[i + 1]).
+  std::string char_table_;
+  std::vector<size_t> char_offsets_;
 
   const std::vector<int> IGNORE_TOKEN = {0};
 };
@@ -93,33 +105,30 @@ public:
       maxWidth = std::max(maxWidth, img.size[numDims - 1]);
     }
 
-    std::vector<cv::Mat> paddedImages;
-
-    for (const auto &img : input) {
-      int currentWidth = img.size[numDims - 1];
-
-      if (currentWidth == maxWidth) {
-        paddedImages.push_back(img.clone());
-        continue;
-      }
+    // Every image is copied once, straight into its zero padded slot of the
+    // batch tensor.
+    std::vector<int> batchSizes = {(int)input.size()};
+    for (int i = 0; i < numDims; ++i) {
+      batchSizes.push_back(input[0].size[i]);
+    }
+    batchSizes.back() = maxWidth;
+    cv::Mat batch = AcquireMat(batchSizes, dtype);
 
-      std::vector<int> newSizes(numDims);
-      for (int i = 0; i < numDims - 1; ++i) {
-        newSizes[i] = img.size[i];
+    const size_t elemSize = input[0].elemSize();
+    size_t rows = 1;
+    for (int i = 0; i < numDims - 1; ++i) {
+      rows *= input[0].size[i];
+    }
+    const size_t dstRowBytes = maxWidth * elemSize;
+    uchar *dst = batch.data;
+    for (const auto &item : input) {
+      cv::Mat img = item.isContinuous() ? item : CloneCounter::Clone(item);
+      const size_t srcRowBytes = img.size[numDims - 1] * elemSize;
+      for (size_t r = 0; r < rows; ++r, dst += dstRowBytes) {
+        std::memcpy(dst, img.data + r * srcRowBytes, srcRowBytes);
+        std::memset(dst + srcRowBytes, 0, dstRowBytes - srcRowBytes);
       }
-      newSizes[numDims - 1] = maxWidth;
-
-      cv::Mat paddedImg(numDims, newSizes.data(), dtype, cv::Scalar::all(0));
-
-      std::vector<cv::Range> srcRanges(numDims, cv::Range::all());
-
-      std::vector<cv::Range> dstRanges(numDims, cv::Range::all());
-      dstRanges[numDims - 1] = cv::Range(0, currentWidth);
-
-      img.copyTo(paddedImg(dstRanges));
-
-      paddedImages.push_back(paddedImg);
     }
-    return ToBatch::Apply(paddedImages);
+    return std::vector<cv::Mat>{batch};
   }
 };
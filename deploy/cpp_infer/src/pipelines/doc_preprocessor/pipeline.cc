@@ -120,11 +120,20 @@ _DocPreprocessorPipeline::_DocPreprocessorPipeline(
 
 std::vector<std::unique_ptr<BaseCVResult>>
 _DocPreprocessorPipeline::Predict(const std::vector<std::string> &input) {
-  auto model_setting = GetModelSettings();
-  auto status = CheckModelSettingsVaild(model_setting);
-  if (!status.ok()) {
-    INFOE("the input params for model settings are invalid!: %s",
-          status.ToString().c_str());
+  auto batches = batch_sampler_ptr_->Apply(input);
+  if (!batches.ok()) {
+    INFOE("pipeline get sample fail : %s", batches.status().ToString().c_str());
+    exit(-1);
+  }
+  return PredictBatches(batches.value(), batch_sampler_ptr_->InputPath());
+}
+
+std::vector<std::unique_ptr<BaseCVResult>>
+_DocPreprocessorPipeline::Predict(const std::vector<cv::Mat> &input,
+                                  const std::vector<std::string> &input_path) {
+  if (!input_path.empty() && input_path.size() != input.size()) {
+    INFOE("Got %d input paths for %d images.", (int)input_path.size(),
+          (int)input.size());
     exit(-1);
   }
   auto batches = batch_sampler_ptr_->Apply(input);
@@ -132,18 +141,29 @@ _DocPreprocessorPipeline::Predict(const std::vector<std::string> &input) {
     INFOE("pipeline get sample fail : %s", batches.status().ToString().c_str());
     exit(-1);
   }
-  auto input_path = batch_sampler_ptr_->InputPath();
+  return PredictBatches(batches.value(), input_path);
+}
+
+std::vector<std::unique_ptr<BaseCVResult>>
+_DocPreprocessorPipeline::PredictBatches(
+    std::vector<std::vector<cv::Mat>> &batches,
+    const std::vector<std::string> &input_path) {
+  auto model_setting = GetModelSettings();
+  auto status = CheckModelSettingsVaild(model_setting);
+  if (!status.ok()) {
+    INFOE("the input params for model settings are invalid!: %s",
+          status.ToString().c_str());
+    exit(-1);
+  }
   int index = 0;
   std::vector<cv::Mat> origin_image = {};
 
   std::vector<std::unique_ptr<BaseCVResult>> base_cv_result_ptr_vec = {};
   std::vector<DocPreprocessorPipelineResult> pipeline_result_vec = {};
   pipeline_result_vec_.clear();
-  for (auto &batch_data : batches.value()) {
-    origin_image.reserve(batch_data.size());
-    for (const auto &mat : batch_data) {
-      origin_image.push_back(mat.clone());
-    }
+  for (auto &batch_data : batches) {
+    // Nothing below writes into batch_data, the results share it.
+    origin_image = batch_data;
     std::vector<int> angles = {};
     std::vector<cv::Mat> rotate_images = {};
     if (model_setting["use_doc_orientation_classify"]) {
@@ -188,7 +208,9 @@ _DocPreprocessorPipeline::Predict(const std::vector<std::string> &input) {
     pipeline_result_vec.clear();
     for (int i = 0; i < output_imgs.size(); i++, index++) {
       DocPreprocessorPipelineResult pipeline_result;
-      pipeline_result.input_path = input_path[index];
+      if (index < input_path.size()) {
+        pipeline_result.input_path = input_path[index];
+      }
       pipeline_result.input_image = origin_image[i];
       pipeline_result.model_settings = model_setting;
       pipeline_result.angle = angles[i];
@@ -208,7 +230,7 @@ _DocPreprocessorPipeline::Predict(const std::vector<std::string> &input) {
     }
   }
   return base_cv_result_ptr_vec;
-};
+}
 
 std::unordered_map<std::string, bool>
 _DocPreprocessorPipeline::GetModelSettings(
@@ -249,30 +271,37 @@ DocPreprocessorPipeline::Predict(const std::vector<std::string> &input) {
   if (thread_num_ == 1) {
     return infer_->Predict(input);
   }
+  // Only the paths are listed here, every image is decoded once by the
+  // instance that processes it.
   batch_sampler_ptr_ =
       std::unique_ptr<BaseBatchSampler>(new ImageBatchSampler(1));
-  auto nomeaning = batch_sampler_ptr_->Apply(input);
-  int input_num = nomeaning.value().size();
-  if (thread_num_ > input_num) {
-    INFOW("thread num exceed input num, will set %d", input_num);
-    thread_num_ = input_num;
-  }
-  int infer_batch_num = input_num / thread_num_;
-  auto status = batch_sampler_ptr_->SetBatchSize(infer_batch_num);
-  if (!status.ok()) {
-    INFOE("Set batch size fail : %s", status.ToString().c_str());
-    exit(-1);
-  }
-  auto infer_batch_data =
-      batch_sampler_ptr_->SampleFromVectorToStringVector(input);
-  if (!infer_batch_data.ok()) {
+  auto input_paths = batch_sampler_ptr_->SampleFromVectorToStringVector(input);
+  if (!input_paths.ok()) {
     INFOE("Get infer batch data fail : %s",
-          infer_batch_data.status().ToString().c_str());
+          input_paths.status().ToString().c_str());
     exit(-1);
   }
+  int input_num = input_paths.value().size();
   std::vector<std::unique_ptr<BaseCVResult>> results = {};
+  if (input_num == 0) {
+    return results;
+  }
+  int thread_num = thread_num_;
+  if (thread_num > input_num) {
+    INFOW("thread num exceed input num, will set %d", input_num);
+    thread_num = input_num;
+  }
+  int infer_batch_num = input_num / thread_num;
+  std::vector<std::vector<std::string>> infer_batch_data = {};
+  for (auto &path : input_paths.value()) {
+    if (infer_batch_data.empty() ||
+        infer_batch_data.back().size() == infer_batch_num) {
+      infer_batch_data.push_back({});
+    }
+    infer_batch_data.back().push_back(path.front());
+  }
   results.reserve(input_num);
-  for (auto &infer_data : infer_batch_data.value()) {
+  for (auto &infer_data : infer_batch_data) {
     auto status =
         AutoParallelSimpleInferencePipeline::PredictThread(infer_data);
     if (!status.ok()) {
@@ -280,11 +309,11 @@ DocPreprocessorPipeline::Predict(const std::vector<std::string> &input) {
       exit(-1);
     }
   }
-  for (int i = 0; i < infer_batch_data.value().size(); i++) {
+  for (int i = 0; i < infer_batch_data.size(); i++) {
     auto infer_data_result = GetResult();
     if (!infer_data_result.ok()) {
       INFOE("Get infer result fail : %s",
-            infer_batch_data.status().ToString().c_str());
+            infer_data_result.status().ToString().c_str());
       exit(-1);
     }
     results.insert(results.end(),
@@ -66,6 +66,9 @@ public:
 
   std::vector<std::unique_ptr<BaseCVResult>>
   Predict(const std::vector<std::string> &input) override;
+  std::vector<std::unique_ptr<BaseCVResult>>
+  Predict(const std::vector<cv::Mat> &input,
+          const std::vector<std::string> &input_path) override;
 
   std::unordered_map<std::string, bool> GetModelSettings(
       absl::optional<bool> use_doc_orientation_classify = absl::nullopt,
@@ -80,6 +83,10 @@ public:
   void OverrideConfig();
 
 private:
+  std::vector<std::unique_ptr<BaseCVResult>>
+  PredictBatches(std::vector<std::vector<cv::Mat>> &batches,
+                 const std::vector<std::string> &input_path);
+
   bool use_doc_orientation_classify_;
   bool use_doc_unwarping_;
   std::unique_ptr<BasePredictor> doc_ori_classify_model_;
@@ -56,8 +56,13 @@ void DocPreprocessorResult::SaveToImg(const std::string &save_path) {
   for (int tno = 0; tno < 3; ++tno) {
     DrawText(img_show, txt_list[tno], beg_w_list[tno], h, region_w_list[tno]);
   }
-  auto full_path = Utility::SmartCreateDirectoryForImage(
-      save_path, pipeline_result_.input_path);
+  std::string input_path = pipeline_result_.input_path;
+  if (input_path.empty()) {
+    INFOW("Input path is empty, will use output.png instead!");
+    input_path = "output.png";
+  }
+  auto full_path =
+      Utility::SmartCreateDirectoryForImage(save_path, input_path);
   if (!full_path.ok()) {
     INFOE(full_path.status().ToString().c_str());
     exit(-1);
@@ -99,8 +104,14 @@ void DocPreprocessorResult::SaveToJson(const std::string &save_path) const {
   j["model_settings"] = pipeline_result_.model_settings;
   j["angle"] = pipeline_result_.angle;
 
-  auto full_path = Utility::SmartCreateDirectoryForJson(
-      save_path, pipeline_result_.input_path);
+  absl::StatusOr<std::string> full_path;
+  if (pipeline_result_.input_path.empty()) {
+    INFOW("Input path is empty, will use output_res.json instead!");
+    full_path = Utility::SmartCreateDirectoryForJson(save_path, "output");
+  } else {
+    full_path = Utility::SmartCreateDirectoryForJson(
+        save_path, pipeline_result_.input_path);
+  }
   if (!full_path.ok()) {
     INFOE(full_path.status().ToString().c_str());
     exit(-1);
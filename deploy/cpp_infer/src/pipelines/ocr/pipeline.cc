@@ -14,10 +14,13 @@
 
 #include "pipeline.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include "result.h"
 #include "src/utils/args.h"
-_OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
-    : BasePipeline(), params_(params) {
+_OCRPipeline::_OCRPipeline(const OCRPipelineParams &params, int stages)
+    : BasePipeline(), params_(params), stages_(stages) {
   if (params.paddlex_config.has_value()) {
     if (params.paddlex_config.value().IsStr()) {
       config_ = YamlConfig(params.paddlex_config.value().GetStr());
@@ -34,6 +37,18 @@ _OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
     config_ = YamlConfig(config_path.value());
   }
   OverrideConfig();
+  // "batch_size" is also the suffix of every SubModules batch size, so the
+  // pipeline level value is looked up by its exact key.
+  if (config_.HasKey("batch_size").ok()) {
+    const std::string &batch_size = config_.Data()["batch_size"];
+    if (batch_size.empty() ||
+        !std::all_of(batch_size.begin(), batch_size.end(), ::isdigit) ||
+        std::stoi(batch_size) < 1) {
+      INFOE("Pipeline batch_size config error : %s", batch_size.c_str());
+      exit(-1);
+    }
+    pipeline_batch_size_ = std::stoi(batch_size);
+  }
   auto result_use_doc_orientation_classify =
       config_.GetBool("use_doc_orientation_classify", true);
   if (!result_use_doc_orientation_classify.ok()) {
@@ -61,15 +76,22 @@ _OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
             result_doc_preprocessor_config.status().ToString().c_str());
       exit(-1);
     }
+    auto &doc_preprocessor_config = result_doc_preprocessor_config.value();
+    if (!YamlConfig(doc_preprocessor_config).FindKey("batch_size").ok()) {
+      doc_preprocessor_config["SubPipelines.DocPreprocessor.batch_size"] =
+          std::to_string(pipeline_batch_size_);
+    }
     DocPreprocessorPipelineParams params;
     params.device = params_.device;
     params.precision = params_.precision;
     params.enable_mkldnn = params_.enable_mkldnn;
     params.mkldnn_cache_capacity = params_.mkldnn_cache_capacity;
     params.cpu_threads = params_.cpu_threads;
-    params.paddlex_config = result_doc_preprocessor_config.value();
-    doc_preprocessors_pipeline_ =
-        CreatePipeline<_DocPreprocessorPipeline>(params);
+    params.paddlex_config = doc_preprocessor_config;
+    if (stages_ & kDocPreprocess) {
+      doc_preprocessors_pipeline_ =
+          CreatePipeline<_DocPreprocessorPipeline>(params);
+    }
 
     use_doc_orientation_classify_ =
         config_.GetBool("DocPreprocessor.use_doc_orientation_classify", true)
@@ -116,7 +138,9 @@ _OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
       exit(-1);
     }
     params.model_dir = result_model_dir.value();
-    textline_orientation_model_ = CreateModule<ClasPredictor>(params);
+    if (stages_ & kTextLineOrientation) {
+      textline_orientation_model_ = CreateModule<ClasPredictor>(params);
+    }
   }
   auto text_type = config_.GetString("text_type");
   if (!text_type.ok()) {
@@ -145,12 +169,25 @@ _OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
     params_det.input_shape =
         config_.SmartParseVector(result_det_input_shape.value()).vec_int;
   }
+  // Sequences are also stored per element as "bucket_sizes[i]", so the list
+  // is looked up by its exact key.
+  auto it_det_bucket_sizes =
+      config_.Data().find("SubModules.TextDetection.bucket_sizes");
+  if (it_det_bucket_sizes != config_.Data().end() &&
+      it_det_bucket_sizes->second != "null") {
+    params_det.bucket_sizes =
+        config_.SmartParseVector(it_det_bucket_sizes->second).vec_int;
+  }
   params_det.device = params_.device;
   params_det.precision = params_.precision;
   params_det.enable_mkldnn = params_.enable_mkldnn;
   params_det.mkldnn_cache_capacity = params_.mkldnn_cache_capacity;
   params_det.cpu_threads = params_.cpu_threads;
   params_det.batch_size = config_.GetInt("TextDetection.batch_size", 1).value();
+  float crop_axis_aligned_epsilon =
+      config_.GetFloat("TextDetection.crop_axis_aligned_epsilon", 1.0).value();
+  int crop_parallel_threshold =
+      config_.GetInt("TextDetection.crop_parallel_threshold", 64).value();
   if (text_type_ == "general") {
     params_det.limit_side_len =
         config_.GetInt("TextDetection.limit_side_len", 960).value();
@@ -164,7 +201,9 @@ _OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
     params_det.unclip_ratio =
         config_.GetFloat("TextDetection.unclip_ratio", 2.0).value();
     sort_boxes_ = ComponentsProcessor::SortQuadBoxes;
-    crop_by_polys_ = std::unique_ptr<CropByPolys>(new CropByPolys("quad"));
+    crop_by_polys_ = std::unique_ptr<CropByPolys>(
+        new CropByPolys("quad", crop_axis_aligned_epsilon,
+                        crop_parallel_threshold));
   } else if (text_type_ == "seal") {
     params_det.limit_side_len =
         config_.GetInt("TextDetection.limit_side_len", 736).value();
@@ -178,12 +217,16 @@ _OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
     params_det.unclip_ratio =
         config_.GetFloat("TextDetection.unclip_ratio", 0.5).value();
     sort_boxes_ = ComponentsProcessor::SortPolyBoxes;
-    crop_by_polys_ = std::unique_ptr<CropByPolys>(new CropByPolys("poly"));
+    crop_by_polys_ = std::unique_ptr<CropByPolys>(
+        new CropByPolys("poly", crop_axis_aligned_epsilon,
+                        crop_parallel_threshold));
   } else {
     INFOE("Unsupported text type We %s", text_type.value().c_str());
     exit(-1);
   }
-  text_det_model_ = CreateModule<TextDetPredictor>(params_det);
+  if (stages_ & kTextDetection) {
+    text_det_model_ = CreateModule<TextDetPredictor>(params_det);
+  }
 
   text_det_params_.text_det_limit_side_len = params_det.limit_side_len.value();
   text_det_params_.text_det_limit_type = params_det.limit_type.value();
@@ -191,6 +234,17 @@ _OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
   text_det_params_.text_det_thresh = params_det.thresh.value();
   text_det_params_.text_det_box_thresh = params_det.box_thresh.value();
   text_det_params_.text_det_unclip_ratio = params_det.unclip_ratio.value();
+  auto result_reduced_decode =
+      config_.GetBool("TextDetection.reduced_decode", false);
+  if (!result_reduced_decode.ok()) {
+    INFOE("TextDetection reduced_decode config error : %s",
+          result_reduced_decode.status().ToString().c_str());
+    exit(-1);
+  }
+  // Boxes found on a reduced page are mapped back by scaling, which does not
+  // hold once the doc preprocessor has rotated or unwarped the page.
+  reduced_decode_ = result_reduced_decode.value() && !use_doc_preprocessor_ &&
+                    !params_det.input_shape.has_value();
 
   TextRecPredictorParams params_rec;
   auto result_text_rec_model_name =
@@ -226,12 +280,36 @@ _OCRPipeline::_OCRPipeline(const OCRPipelineParams &params)
   params_rec.batch_size =
       config_.GetInt("TextRecognition.batch_size", 1).value();
 
-  text_rec_model_ = CreateModule<TextRecPredictor>(params_rec);
+  if (stages_ & kTextRecognition) {
+    text_rec_model_ = CreateModule<TextRecPredictor>(params_rec);
+  }
+  // Without textline orientation the crops only feed recognition, so they
+  // are cut out at the recognition input size right away.
+  if (!use_textline_orientation_) {
+    std::shared_ptr<OCRReisizeNormImg> rec_resize(
+        new OCRReisizeNormImg(params_rec.input_shape));
+    crop_by_polys_->SetTargetSize([rec_resize](const cv::Size &size) {
+      return rec_resize->ResizedSize(size);
+    });
+  }
   text_rec_score_thresh_ =
       config_.GetFloat("TextRecognition.score_thresh", 0.0).value();
+  auto result_cross_image_batching =
+      config_.GetBool("TextRecognition.cross_image_batching", false);
+  if (!result_cross_image_batching.ok()) {
+    INFOE("TextRecognition cross_image_batching config error : %s",
+          result_cross_image_batching.status().ToString().c_str());
+    exit(-1);
+  }
+  text_rec_cross_image_batching_ = result_cross_image_batching.value();
 
-  batch_sampler_ptr_ = std::unique_ptr<BaseBatchSampler>(
-      new ImageBatchSampler(1)); //** pipeline batch_size
+  batch_sampler_ptr_ = std::unique_ptr<StreamingImageBatchSampler>(
+      new StreamingImageBatchSampler(pipeline_batch_size_,
+                                     params_.prefetch_batches));
+  if (reduced_decode_) {
+    batch_sampler_ptr_->SetDecoder(
+        [this](const std::string &path) { return LoadImage(path); });
+  }
 };
 
 absl::StatusOr<std::vector<cv::Mat>>
@@ -265,6 +343,61 @@ _OCRPipeline::RotateImage(const std::vector<cv::Mat> &image_array_list,
   return rotated_images;
 }
 
+// Largest JPEG decode scale that still leaves the page at least as large as
+// the detection input it is resized to.
+int _OCRPipeline::DecodeScale(const cv::Size &size) const {
+  auto det_size = DetResizeForTest::LimitedSize(
+      size, text_det_params_.text_det_limit_side_len,
+      text_det_params_.text_det_limit_type,
+      text_det_params_.text_det_max_side_limit);
+  if (!det_size.ok()) {
+    return 1;
+  }
+  for (int scale = 8; scale > 1; scale /= 2) {
+    if ((size.width + scale - 1) / scale >= det_size.value().width &&
+        (size.height + scale - 1) / scale >= det_size.value().height) {
+      return scale;
+    }
+  }
+  return 1;
+}
+
+// Decodes a JPEG page at the reduced size DecodeScale picks for it and
+// records the size it has at full resolution, read from the header once.
+absl::StatusOr<StreamingImageBatchSampler::DecodedImage>
+_OCRPipeline::LoadImage(const std::string &path) const {
+  StreamingImageBatchSampler::DecodedImage page;
+  if (reduced_decode_) {
+    auto jpeg_header = Utility::ReadJpegHeader(path);
+    if (jpeg_header.ok()) {
+      // The decoder turns the page by its EXIF orientation at any scale.
+      cv::Size full_size = jpeg_header.value().OrientedSize();
+      int scale = DecodeScale(full_size);
+      if (scale > 1) {
+        auto image = Utility::MyLoadImage(path, scale);
+        if (!image.ok()) {
+          return image.status();
+        }
+        // The decoder rounds the sides up. A page of any other size was
+        // turned differently from what the header said, so the size it has
+        // at full resolution is not known and it is decoded in full.
+        if (image.value().cols == (full_size.width + scale - 1) / scale &&
+            image.value().rows == (full_size.height + scale - 1) / scale) {
+          page.image = image.value();
+          page.full_size = full_size;
+          return page;
+        }
+      }
+    }
+  }
+  auto image = Utility::MyLoadImage(path);
+  if (!image.ok()) {
+    return image.status();
+  }
+  page.image = image.value();
+  return page;
+}
+
 std::unordered_map<std::string, bool> _OCRPipeline::GetModelSettings() const {
   std::unordered_map<std::string, bool> model_settings = {};
   model_settings["use_doc_preprocessor"] = use_doc_preprocessor_;
@@ -274,216 +407,469 @@ std::unordered_map<std::string, bool> _OCRPipeline::GetModelSettings() const {
 
 std::vector<std::unique_ptr<BaseCVResult>>
 _OCRPipeline::Predict(const std::vector<std::string> &input) {
-  auto model_settings = GetModelSettings();
-  auto batches = batch_sampler_ptr_->Apply(input);
-  auto batches_string =
-      batch_sampler_ptr_->SampleFromVectorToStringVector(input);
-  if (!batches.ok()) {
-    INFOE("pipeline get sample fail : %s", batches.status().ToString().c_str());
+  auto status = batch_sampler_ptr_->Start(input);
+  if (!status.ok()) {
+    INFOE("pipeline get sample fail : %s", status.ToString().c_str());
     exit(-1);
   }
-  if (!batches_string.ok()) {
-    INFOE("pipeline get sample fail : %s",
-          batches_string.status().ToString().c_str());
+  std::vector<std::unique_ptr<BaseCVResult>> base_results = {};
+  pipeline_result_vec_.clear();
+  while (true) {
+    OCRPipelineBatch batch;
+    auto has_next = batch_sampler_ptr_->Next(
+        batch.input_image, batch.input_path, &batch.full_sizes);
+    if (!has_next.ok()) {
+      INFOE("pipeline get sample fail : %s",
+            has_next.status().ToString().c_str());
+      exit(-1);
+    }
+    if (!has_next.value()) {
+      break;
+    }
+    PredictBatch(batch, base_results);
+  }
+  return base_results;
+}
+
+std::vector<std::unique_ptr<BaseCVResult>>
+_OCRPipeline::Predict(const std::vector<cv::Mat> &input,
+                      const std::vector<std::string> &input_path) {
+  if (!input_path.empty() && input_path.size() != input.size()) {
+    INFOE("Got %d input paths for %d images.", (int)input_path.size(),
+          (int)input.size());
     exit(-1);
   }
-  auto input_path = batch_sampler_ptr_->InputPath();
-  int index = 0;
-  std::vector<cv::Mat> origin_image = {};
   std::vector<std::unique_ptr<BaseCVResult>> base_results = {};
   pipeline_result_vec_.clear();
-  for (int i = 0; i < batches.value().size(); i++) {
-    origin_image.reserve(batches.value()[i].size());
-    for (const auto &mat : batches.value()[i]) {
-      origin_image.push_back(mat.clone());
-    }
-    std::vector<DocPreprocessorPipelineResult>
-        doc_preprocessors_pipeline_results = {};
-    if (use_doc_preprocessor_) {
-      doc_preprocessors_pipeline_->Predict(batches_string.value()[i]);
-      doc_preprocessors_pipeline_results =
-          static_cast<_DocPreprocessorPipeline *>(
-              doc_preprocessors_pipeline_.get())
-              ->PipelineResult();
-    } else {
+  for (int i = 0; i < input.size(); i += pipeline_batch_size_) {
+    int end = std::min(i + pipeline_batch_size_, (int)input.size());
+    OCRPipelineBatch batch;
+    batch.input_image.assign(input.begin() + i, input.begin() + end);
+    if (!input_path.empty()) {
+      batch.input_path.assign(input_path.begin() + i,
+                              input_path.begin() + end);
+    }
+    PredictBatch(batch, base_results);
+  }
+  return base_results;
+}
+
+static void StoreClonedBytes(OCRPipelineBatch &batch) {
+  for (int k = 0; k < batch.results.size(); k++) {
+    batch.results[k].cloned_bytes = batch.page_cloned_bytes[k];
+    batch.results[k].batch_cloned_bytes = batch.cloned_bytes;
+  }
+}
+
+void _OCRPipeline::PredictBatch(
+    OCRPipelineBatch &batch,
+    std::vector<std::unique_ptr<BaseCVResult>> &base_results) {
+  auto status = PreprocessImages(batch);
+  if (status.ok()) {
+    status = DetectText(batch);
+  }
+  if (status.ok()) {
+    status = ClassifyTextLines(batch);
+  }
+  if (status.ok()) {
+    status = RecognizeText(batch);
+  }
+  if (!status.ok()) {
+    INFOE("OCR pipeline predict fail : %s", status.ToString().c_str());
+    exit(-1);
+  }
+  StoreClonedBytes(batch);
+  for (auto &res : batch.results) {
+    pipeline_result_vec_.push_back(res);
+    base_results.push_back(std::unique_ptr<BaseCVResult>(new OCRResult(res)));
+  }
+}
+
+absl::Status _OCRPipeline::PreprocessImages(OCRPipelineBatch &batch) {
+  batch.doc_preprocessor_results.clear();
+  batch.page_cloned_bytes.assign(
+      std::max(batch.input_image.size(), batch.input_path.size()), 0);
+  // Images passed in by the caller are used at the size they were given.
+  batch.full_sizes.resize(batch.input_image.size());
+  for (int i = batch.input_image.size(); i < batch.input_path.size(); i++) {
+    CloneCounter::Scope page_scope(&batch.page_cloned_bytes[i]);
+    auto result_image = LoadImage(batch.input_path[i]);
+    if (!result_image.ok()) {
+      return result_image.status();
+    }
+    batch.input_image.push_back(result_image.value().image);
+    batch.full_sizes.push_back(result_image.value().full_size);
+  }
+  if (use_doc_preprocessor_) {
+    CloneCounter::Scope batch_scope(&batch.cloned_bytes);
+    doc_preprocessors_pipeline_->Predict(batch.input_image, batch.input_path);
+    batch.doc_preprocessor_results =
+        static_cast<_DocPreprocessorPipeline *>(
+            doc_preprocessors_pipeline_.get())
+            ->PipelineResult();
+  } else {
+    for (auto &image : batch.input_image) {
       DocPreprocessorPipelineResult result;
-      for (auto &image : batches.value()[i]) {
-        result.output_image = image.clone();
-        doc_preprocessors_pipeline_results.push_back(result);
+      result.output_image = image;
+      batch.doc_preprocessor_results.push_back(result);
+    }
+  }
+  int image_num = batch.input_image.size();
+  batch.input_image.clear();
+  if (batch.doc_preprocessor_results.size() != image_num) {
+    return absl::InternalError(
+        "Doc preprocessor returned " +
+        std::to_string(batch.doc_preprocessor_results.size()) +
+        " results for " + std::to_string(image_num) + " images");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status _OCRPipeline::DetectText(OCRPipelineBatch &batch) {
+  auto model_settings = GetModelSettings();
+  std::vector<cv::Mat> doc_preprocessor_pipeline_images = {};
+  for (auto &item : batch.doc_preprocessor_results) {
+    doc_preprocessor_pipeline_images.push_back(item.output_image);
+  }
+  {
+    CloneCounter::Scope batch_scope(&batch.cloned_bytes);
+    text_det_model_->Predict(doc_preprocessor_pipeline_images);
+  }
+  std::vector<TextDetPredictorResult> det_results =
+      static_cast<TextDetPredictor *>(text_det_model_.get())
+          ->PredictorResult();
+  batch.dt_polys_list.clear();
+  for (int k = 0; k < det_results.size(); k++) {
+    CloneCounter::Scope page_scope(&batch.page_cloned_bytes[k]);
+    auto &item = det_results[k];
+    // A page decoded at a reduced size is decoded in full only once it is
+    // known to have text lines to crop.
+    if (k < batch.full_sizes.size() && !batch.full_sizes[k].empty() &&
+        !item.dt_polys.empty()) {
+      auto &image = batch.doc_preprocessor_results[k].output_image;
+      auto full_image = Utility::MyLoadImage(batch.input_path[k]);
+      if (!full_image.ok()) {
+        return full_image.status();
+      }
+      if (full_image.value().size() != batch.full_sizes[k]) {
+        return absl::InternalError("Image changed size while decoding: " +
+                                   batch.input_path[k]);
       }
+      float scale_x = (float)batch.full_sizes[k].width / image.cols;
+      float scale_y = (float)batch.full_sizes[k].height / image.rows;
+      for (auto &poly : item.dt_polys) {
+        for (auto &point : poly) {
+          point.x *= scale_x;
+          point.y *= scale_y;
+        }
+      }
+      image = full_image.value();
+    }
+    std::vector<std::vector<cv::Point2f>> dt_polys;
+    if (!item.dt_polys.empty()) {
+      auto order = sort_boxes_(item.dt_polys);
+      dt_polys.reserve(order.size());
+      for (auto index : order) {
+        dt_polys.push_back(std::move(item.dt_polys[index]));
+      }
+    }
+    batch.dt_polys_list.push_back(std::move(dt_polys));
+  }
+  batch.results =
+      std::vector<OCRPipelineResult>(batch.doc_preprocessor_results.size());
+  for (int k = 0; k < batch.results.size(); k++) {
+    if (k < batch.input_path.size()) {
+      batch.results[k].input_path = batch.input_path[k];
     }
-    std::vector<cv::Mat> doc_preprocessor_pipeline_images = {};
-    std::vector<cv::Mat> doc_preprocessor_pipeline_images_copy = {};
-    for (auto &item : doc_preprocessors_pipeline_results) {
-      doc_preprocessor_pipeline_images.push_back(item.output_image);
-      doc_preprocessor_pipeline_images_copy.push_back(
-          item.output_image.clone());
+    batch.results[k].doc_preprocessor_res = batch.doc_preprocessor_results[k];
+    batch.results[k].dt_polys = batch.dt_polys_list[k];
+    batch.results[k].model_settings = model_settings;
+    batch.results[k].text_det_params = text_det_params_;
+    batch.results[k].text_type = text_type_;
+    batch.results[k].text_rec_score_thresh = text_rec_score_thresh_;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status _OCRPipeline::ClassifyTextLines(OCRPipelineBatch &batch) {
+  batch.indices.clear();
+  for (int j = 0; j < batch.dt_polys_list.size(); j++) {
+    if (!batch.dt_polys_list[j].empty()) {
+      batch.indices.push_back(j);
+    }
+  }
+  batch.sub_images.clear();
+  batch.chunk_indices = std::vector<int>(1, 0);
+  if (batch.indices.empty()) {
+    return absl::OkStatus();
+  }
+  for (auto &idx : batch.indices) {
+    CloneCounter::Scope page_scope(&batch.page_cloned_bytes[idx]);
+    auto crop_start = std::chrono::steady_clock::now();
+    auto result_all_subs_of_img =
+        (*crop_by_polys_)(batch.doc_preprocessor_results[idx].output_image,
+                          batch.dt_polys_list[idx]);
+    if (!result_all_subs_of_img.ok()) {
+      return result_all_subs_of_img.status();
     }
-    text_det_model_->Predict(doc_preprocessor_pipeline_images_copy);
-    std::vector<TextDetPredictorResult> det_results =
-        static_cast<TextDetPredictor *>(text_det_model_.get())
+    batch.results[idx].crop_time_ms =
+        std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - crop_start)
+            .count();
+    batch.sub_images.insert(batch.sub_images.end(),
+                            result_all_subs_of_img.value().begin(),
+                            result_all_subs_of_img.value().end());
+    batch.chunk_indices.emplace_back(batch.chunk_indices.back() +
+                                     result_all_subs_of_img.value().size());
+  }
+  std::vector<int> angles = {};
+  if (use_textline_orientation_) {
+    CloneCounter::Scope batch_scope(&batch.cloned_bytes);
+    textline_orientation_model_->Predict(batch.sub_images);
+    auto textline_orientation_model_results =
+        static_cast<ClasPredictor *>(textline_orientation_model_.get())
             ->PredictorResult();
-    std::vector<std::vector<std::vector<cv::Point2f>>> dt_polys_list = {};
-    for (auto &item : det_results) {
-      if (!item.dt_polys.empty()) {
-        auto sort_item = sort_boxes_(item.dt_polys);
-        dt_polys_list.push_back(sort_item);
-      } else {
-        dt_polys_list.push_back(std::vector<std::vector<cv::Point2f>>{});
-      }
+    for (auto &result_angle : textline_orientation_model_results) {
+      angles.push_back(result_angle.class_ids[0]);
     }
+    auto result_all_subs_of_imgs = RotateImage(batch.sub_images, angles);
+    if (!result_all_subs_of_imgs.ok()) {
+      return result_all_subs_of_imgs.status();
+    }
+    batch.sub_images = result_all_subs_of_imgs.value();
+  } else {
+    angles = std::vector<int>(batch.sub_images.size(), -1);
+  }
+  for (int l = 0; l < batch.indices.size(); l++) {
+    for (int m = batch.chunk_indices[l]; m < batch.chunk_indices[l + 1]; m++) {
+      batch.results[batch.indices[l]].textline_orientation_angles.push_back(
+          angles[m]);
+    }
+  }
+  return absl::OkStatus();
+}
 
-    std::vector<int> indices = {};
-    for (int j = 0; j < doc_preprocessor_pipeline_images.size(); j++) {
-      if (!dt_polys_list.empty() && !dt_polys_list[j].empty()) {
-        indices.push_back(j);
+absl::Status _OCRPipeline::RecognizeText(OCRPipelineBatch &batch) {
+  auto &indices = batch.indices;
+  auto &chunk_indices = batch.chunk_indices;
+  auto &all_subs_of_imgs = batch.sub_images;
+  if (!indices.empty()) {
+    std::vector<std::pair<int, int>> rec_groups = {};
+    if (text_rec_cross_image_batching_) {
+      rec_groups.push_back({0, chunk_indices.back()});
+    } else {
+      for (int l = 0; l < indices.size(); l++) {
+        rec_groups.push_back({chunk_indices[l], chunk_indices[l + 1]});
       }
     }
-    std::vector<OCRPipelineResult> results(
-        doc_preprocessor_pipeline_images.size());
-    for (int k = 0; k < results.size(); k++, index++) {
-      results[k].input_path = input_path[index];
-      results[k].doc_preprocessor_res = doc_preprocessors_pipeline_results[k];
-      results[k].dt_polys = dt_polys_list[k];
-      results[k].model_settings = model_settings;
-      results[k].text_det_params = text_det_params_;
-      results[k].text_type = text_type_;
-      results[k].text_rec_score_thresh = text_rec_score_thresh_;
-    }
-    if (!indices.empty()) {
-      std::vector<cv::Mat> all_subs_of_imgs = {};
-      std::vector<cv::Mat> all_subs_of_imgs_copy = {};
-      std::vector<int> chunk_indices(1, 0);
-      for (auto &idx : indices) {
-        auto result_all_subs_of_img = (*crop_by_polys_)(
-            doc_preprocessor_pipeline_images[idx], dt_polys_list[idx]);
-        if (!result_all_subs_of_img.ok()) {
-          INFOE("Split image fail : ",
-                result_all_subs_of_img.status().ToString().c_str());
-          exit(-1);
-        }
-        all_subs_of_imgs.insert(all_subs_of_imgs.end(),
-                                result_all_subs_of_img.value().begin(),
-                                result_all_subs_of_img.value().end());
-        chunk_indices.emplace_back(chunk_indices.back() +
-                                   result_all_subs_of_img.value().size());
+    std::vector<TextRecPredictorResult> rec_results(all_subs_of_imgs.size());
+    for (int g = 0; g < rec_groups.size(); g++) {
+      // A group holds the lines of one page, unless lines of all the pages
+      // are recognized together.
+      auto &group = rec_groups[g];
+      size_t *group_cloned_bytes = text_rec_cross_image_batching_
+                                       ? &batch.cloned_bytes
+                                       : &batch.page_cloned_bytes[indices[g]];
+      CloneCounter::Scope group_scope(group_cloned_bytes);
+      std::vector<std::pair<int, float>> sorted_subs_info = {};
+      for (int m = group.first; m < group.second; m++) {
+        float sub_img_ratio = (float)all_subs_of_imgs[m].size[1] /
+                              (float)all_subs_of_imgs[m].size[0];
+        sorted_subs_info.push_back({m, sub_img_ratio});
       }
-      for (auto &item : all_subs_of_imgs) {
-        all_subs_of_imgs_copy.push_back(item.clone());
+      std::stable_sort(
+          sorted_subs_info.begin(), sorted_subs_info.end(),
+          [](const std::pair<int, float> &a, const std::pair<int, float> &b) {
+            return a.second < b.second;
+          });
+      std::vector<cv::Mat> sorted_subs_of_img = {};
+      sorted_subs_of_img.reserve(sorted_subs_info.size());
+      for (auto &item : sorted_subs_info) {
+        sorted_subs_of_img.push_back(all_subs_of_imgs[item.first]);
       }
-      std::vector<int> angles = {};
-      if (model_settings["use_textline_orientation"]) {
-        textline_orientation_model_->Predict(all_subs_of_imgs_copy);
-        auto textline_orientation_model_results =
-            static_cast<ClasPredictor *>(textline_orientation_model_.get())
-                ->PredictorResult();
-        textline_orientation_model_results[0].input_image;
-        for (auto &result_angle : textline_orientation_model_results) {
-          angles.push_back(result_angle.class_ids[0]);
-        }
-        auto result_all_subs_of_imgs = RotateImage(all_subs_of_imgs, angles);
-        if (!result_all_subs_of_imgs.ok()) {
-          INFOE("Rotate images fail : %s",
-                result_all_subs_of_imgs.status().ToString().c_str());
-          exit(-1);
-        }
-        all_subs_of_imgs = result_all_subs_of_imgs.value();
-      } else {
-        angles = std::vector<int>(all_subs_of_imgs.size(), -1);
+      text_rec_model_->Predict(sorted_subs_of_img);
+      auto text_rec_model_results =
+          static_cast<TextRecPredictor *>(text_rec_model_.get())
+              ->PredictorResult();
+      for (int m = 0; m < text_rec_model_results.size(); m++) {
+        rec_results[sorted_subs_info[m].first] = text_rec_model_results[m];
       }
-      for (int l = 0; l < indices.size(); l++) {
-        for (int m = chunk_indices[l]; m < chunk_indices[l + 1]; m++) {
-          results[indices[l]].textline_orientation_angles.push_back(angles[m]);
+    }
+    for (int l = 0; l < indices.size(); l++) {
+      auto &result = batch.results[indices[l]];
+      for (int m = chunk_indices[l]; m < chunk_indices[l + 1]; m++) {
+        auto &rec_res = rec_results[m];
+        if (rec_res.rec_score >= text_rec_score_thresh_) {
+          result.rec_texts.push_back(rec_res.rec_text);
+          result.rec_scores.push_back(rec_res.rec_score);
+          result.rec_polys.push_back(
+              batch.dt_polys_list[indices[l]][m - chunk_indices[l]]);
+          result.vis_fonts = rec_res.vis_font;
         }
       }
-      for (int l = 0; l < indices.size(); l++) {
-        std::vector<cv::Mat> all_subs_of_img = {};
-        for (int m = chunk_indices[l]; m < chunk_indices[l + 1]; m++) {
-          all_subs_of_img.push_back(all_subs_of_imgs[m]);
-        }
-        std::vector<std::pair<std::pair<int, float>, TextRecPredictorResult>>
-            sub_img_info_list = {};
+    }
+  }
+  for (auto &res : batch.results) {
+    if (text_type_ == "general") {
+      res.rec_boxes = ComponentsProcessor::ConvertPointsToBoxes(res.rec_polys);
+    }
+  }
+  return absl::OkStatus();
+}
 
-        for (int m = 0; m < all_subs_of_img.size(); m++) {
-          int sub_img_id = m;
-          float sub_img_ratio = (float)all_subs_of_img[m].size[1] /
-                                (float)all_subs_of_img[m].size[0];
-          TextRecPredictorResult result;
-          sub_img_info_list.push_back({{sub_img_id, sub_img_ratio}, result});
-        }
-        std::vector<std::pair<int, float>> sorted_subs_info = {};
-        for (auto &item : sub_img_info_list) {
-          sorted_subs_info.push_back(item.first);
-        }
-        std::sort(
-            sorted_subs_info.begin(), sorted_subs_info.end(),
-            [](const std::pair<int, float> &a, const std::pair<int, float> &b) {
-              return a.second < b.second;
-            });
-        std::vector<cv::Mat> sorted_subs_of_img = {};
-        for (auto &item : sorted_subs_info) {
-          sorted_subs_of_img.push_back(all_subs_of_img[item.first]);
-        }
-        text_rec_model_->Predict(sorted_subs_of_img);
-        auto text_rec_model_results =
-            static_cast<TextRecPredictor *>(text_rec_model_.get())
-                ->PredictorResult();
-        for (int m = 0; m < text_rec_model_results.size(); m++) {
-          int sub_img_id = sorted_subs_info[m].first;
-          sub_img_info_list[sub_img_id].second = text_rec_model_results[m];
-        }
-        for (int sno = 0; sno < sub_img_info_list.size(); sno++) {
-          auto rec_res = sub_img_info_list[sno].second;
-          if (rec_res.rec_score >= text_rec_score_thresh_) {
-            results[l].rec_texts.push_back(rec_res.rec_text);
-            results[l].rec_scores.push_back(rec_res.rec_score);
-            results[l].rec_polys.push_back(dt_polys_list[l][sno]);
-            results[l].vis_fonts = rec_res.vis_font;
-          }
-        }
-      }
+OCRPipeline::OCRPipeline(const OCRPipelineParams &params)
+    : AutoParallelSimpleInferencePipeline(ReplicaParams(params)),
+      thread_num_(params.thread_num),
+      batch_sampler_ptr_(new ImageBatchSampler(1)) {
+  if (params.parallel_mode == "staged") {
+    staged_ = true;
+    auto status = InitStages(params);
+    if (!status.ok()) {
+      INFOE("OCR pipeline stages init fail : %s", status.ToString().c_str());
+      exit(-1);
+    }
+  } else if (params.parallel_mode != "replica") {
+    INFOE("Unsupported parallel mode : %s", params.parallel_mode.c_str());
+    exit(-1);
+  } else if (thread_num_ == 1) {
+    infer_ = std::unique_ptr<BasePipeline>(new _OCRPipeline(params));
+  }
+}
+
+OCRPipelineParams
+OCRPipeline::ReplicaParams(const OCRPipelineParams &params) {
+  // The staged mode runs its own workers, so no replica pool is created.
+  OCRPipelineParams replica_params = params;
+  if (params.parallel_mode == "staged") {
+    replica_params.thread_num = 1;
+  }
+  return replica_params;
+}
+
+absl::Status OCRPipeline::InitStages(const OCRPipelineParams &params) {
+  if (params.stage_replicas.size() != 4) {
+    return absl::InvalidArgumentError(
+        "stage_replicas needs 4 values (preprocess, detection, textline "
+        "orientation, recognition), got " +
+        std::to_string(params.stage_replicas.size()));
+  }
+  if (params.stage_queue_size < 1) {
+    return absl::InvalidArgumentError(
+        "stage_queue_size must be positive, got " +
+        std::to_string(params.stage_queue_size));
+  }
+  staged_executor_ = std::unique_ptr<StagedExecutor<OCRPipelineBatch>>(
+      new StagedExecutor<OCRPipelineBatch>(params.stage_queue_size));
+  const std::vector<std::pair<std::string, int>> stages = {
+      {"preprocess", _OCRPipeline::kDocPreprocess},
+      {"text_detection", _OCRPipeline::kTextDetection},
+      {"textline_orientation", _OCRPipeline::kTextLineOrientation},
+      {"text_recognition", _OCRPipeline::kTextRecognition}};
+  for (int s = 0; s < stages.size(); s++) {
+    if (params.stage_replicas[s] < 1) {
+      return absl::InvalidArgumentError(
+          "stage_replicas must be positive, got " +
+          std::to_string(params.stage_replicas[s]) + " for " +
+          stages[s].first);
     }
-    for (auto &res : results) {
-      if (text_type_ == "general") {
-        res.rec_boxes =
-            ComponentsProcessor::ConvertPointsToBoxes(res.rec_polys);
+    std::vector<StagedExecutor<OCRPipelineBatch>::StageFunc> replicas = {};
+    for (int r = 0; r < params.stage_replicas[s]; r++) {
+      _OCRPipeline *pipeline = new _OCRPipeline(params, stages[s].second);
+      stage_pipelines_.push_back(std::unique_ptr<_OCRPipeline>(pipeline));
+      switch (stages[s].second) {
+      case _OCRPipeline::kDocPreprocess:
+        replicas.push_back([pipeline](OCRPipelineBatch &batch) {
+          return pipeline->PreprocessImages(batch);
+        });
+        break;
+      case _OCRPipeline::kTextDetection:
+        replicas.push_back([pipeline](OCRPipelineBatch &batch) {
+          return pipeline->DetectText(batch);
+        });
+        break;
+      case _OCRPipeline::kTextLineOrientation:
+        replicas.push_back([pipeline](OCRPipelineBatch &batch) {
+          return pipeline->ClassifyTextLines(batch);
+        });
+        break;
+      default:
+        replicas.push_back([pipeline](OCRPipelineBatch &batch) {
+          return pipeline->RecognizeText(batch);
+        });
+        break;
       }
-      pipeline_result_vec_.push_back(res);
-      base_results.push_back(std::unique_ptr<BaseCVResult>(new OCRResult(res)));
+    }
+    auto status = staged_executor_->AddStage(stages[s].first, replicas);
+    if (!status.ok()) {
+      return status;
     }
   }
-  return base_results;
+  pipeline_batch_size_ = stage_pipelines_.front()->PipelineBatchSize();
+  return absl::OkStatus();
 }
 
 std::vector<std::unique_ptr<BaseCVResult>>
-OCRPipeline::Predict(const std::vector<std::string> &input) {
-  if (thread_num_ == 1) {
-    return infer_->Predict(input);
-  }
-  batch_sampler_ptr_ =
-      std::unique_ptr<BaseBatchSampler>(new ImageBatchSampler(1));
-  auto nomeaning = batch_sampler_ptr_->Apply(input);
-  int input_num = nomeaning.value().size();
-  if (thread_num_ > input_num) {
-    INFOW("thread num exceed input num, will set %d", input_num);
-    thread_num_ = input_num;
+OCRPipeline::PredictStaged(const std::vector<cv::Mat> &input,
+                           const std::vector<std::string> &input_path) {
+  int input_num = std::max(input.size(), input_path.size());
+  std::vector<OCRPipelineBatch> batches = {};
+  for (int i = 0; i < input_num; i += pipeline_batch_size_) {
+    int end = std::min(i + pipeline_batch_size_, input_num);
+    OCRPipelineBatch batch;
+    if (!input.empty()) {
+      batch.input_image.assign(input.begin() + i, input.begin() + end);
+    }
+    if (!input_path.empty()) {
+      batch.input_path.assign(input_path.begin() + i,
+                              input_path.begin() + end);
+    }
+    batches.push_back(std::move(batch));
   }
-  int infer_batch_num = input_num / thread_num_;
-  auto status = batch_sampler_ptr_->SetBatchSize(infer_batch_num);
-  if (!status.ok()) {
-    INFOE("Set batch size fail : %s", status.ToString().c_str());
+  auto outputs = staged_executor_->Run(std::move(batches));
+  if (!outputs.ok()) {
+    INFOE("OCR pipeline predict fail : %s",
+          outputs.status().ToString().c_str());
     exit(-1);
   }
-  auto infer_batch_data =
-      batch_sampler_ptr_->SampleFromVectorToStringVector(input);
-  if (!infer_batch_data.ok()) {
-    INFOE("Get infer batch data fail : %s",
-          infer_batch_data.status().ToString().c_str());
-    exit(-1);
+  std::vector<std::unique_ptr<BaseCVResult>> results = {};
+  for (auto &batch : outputs.value()) {
+    StoreClonedBytes(batch);
+    for (auto &res : batch.results) {
+      results.push_back(std::unique_ptr<BaseCVResult>(new OCRResult(res)));
+    }
   }
+  return results;
+}
+
+std::vector<std::unique_ptr<BaseCVResult>>
+OCRPipeline::PredictParallel(const std::vector<cv::Mat> &input,
+                             const std::vector<std::string> &input_path) {
+  int input_num = std::max(input.size(), input_path.size());
   std::vector<std::unique_ptr<BaseCVResult>> results = {};
+  if (input_num == 0) {
+    return results;
+  }
+  int thread_num = thread_num_;
+  if (thread_num > input_num) {
+    INFOW("thread num exceed input num, will set %d", input_num);
+    thread_num = input_num;
+  }
+  int infer_batch_num = input_num / thread_num;
+  std::vector<PipelineInputData> infer_batch_data = {};
+  for (int i = 0; i < input_num; i += infer_batch_num) {
+    int end = std::min(i + infer_batch_num, input_num);
+    PipelineInputData infer_data;
+    if (!input.empty()) {
+      infer_data.input_image.assign(input.begin() + i, input.begin() + end);
+    }
+    if (!input_path.empty()) {
+      infer_data.input_path.assign(input_path.begin() + i,
+                                   input_path.begin() + end);
+    }
+    infer_batch_data.push_back(std::move(infer_data));
+  }
   results.reserve(input_num);
-  for (auto &infer_data : infer_batch_data.value()) {
+  for (auto &infer_data : infer_batch_data) {
     auto status =
         AutoParallelSimpleInferencePipeline::PredictThread(infer_data);
     if (!status.ok()) {
@@ -491,11 +877,11 @@ OCRPipeline::Predict(const std::vector<std::string> &input) {
       exit(-1);
     }
   }
-  for (int i = 0; i < infer_batch_data.value().size(); i++) {
+  for (int i = 0; i < infer_batch_data.size(); i++) {
     auto infer_data_result = GetResult();
     if (!infer_data_result.ok()) {
       INFOE("Get infer result fail : %s",
-            infer_batch_data.status().ToString().c_str());
+            infer_data_result.status().ToString().c_str());
       exit(-1);
     }
     results.insert(results.end(),
@@ -505,8 +891,57 @@ OCRPipeline::Predict(const std::vector<std::string> &input) {
   return results;
 }
 
+std::vector<std::unique_ptr<BaseCVResult>>
+OCRPipeline::Predict(const std::vector<std::string> &input) {
+  if (!staged_ && thread_num_ == 1) {
+    return infer_->Predict(input);
+  }
+  // Only the paths are listed here, every image is decoded once by the
+  // stage or instance that processes it.
+  auto input_paths = batch_sampler_ptr_->SampleFromVectorToStringVector(input);
+  if (!input_paths.ok()) {
+    INFOE("Get infer batch data fail : %s",
+          input_paths.status().ToString().c_str());
+    exit(-1);
+  }
+  std::vector<std::string> paths = {};
+  for (auto &path : input_paths.value()) {
+    paths.push_back(path.front());
+  }
+  if (staged_) {
+    return PredictStaged({}, paths);
+  }
+  return PredictParallel({}, paths);
+}
+
+std::vector<std::unique_ptr<BaseCVResult>>
+OCRPipeline::Predict(const std::vector<cv::Mat> &input,
+                     const std::vector<std::string> &input_path) {
+  if (!input_path.empty() && input_path.size() != input.size()) {
+    INFOE("Got %d input paths for %d images.", (int)input_path.size(),
+          (int)input.size());
+    exit(-1);
+  }
+  for (int i = 0; i < input.size(); i++) {
+    if (input[i].empty()) {
+      INFOE("Input image at index %d is empty.", i);
+      exit(-1);
+    }
+  }
+  if (staged_) {
+    return PredictStaged(input, input_path);
+  }
+  if (thread_num_ == 1) {
+    return infer_->Predict(input, input_path);
+  }
+  return PredictParallel(input, input_path);
+}
+
 void _OCRPipeline::OverrideConfig() {
   auto &data = config_.Data();
+  if (params_.pipeline_batch_size.has_value()) {
+    data["batch_size"] = std::to_string(params_.pipeline_batch_size.value());
+  }
   if (params_.doc_orientation_classify_model_name.has_value()) {
     auto it = config_.FindKey("DocOrientationClassify.model_name");
     if (!it.ok()) {
@@ -742,6 +1177,21 @@ void _OCRPipeline::OverrideConfig() {
       data[key] = Utility::VecToString(params_.text_det_input_shape.value());
     }
   }
+  if (params_.text_det_bucket_sizes.has_value()) {
+    data["SubModules.TextDetection.bucket_sizes"] =
+        Utility::VecToString(params_.text_det_bucket_sizes.value());
+  }
+  if (params_.text_det_reduced_decode.has_value()) {
+    auto it = config_.FindKey("TextDetection.reduced_decode");
+    if (!it.ok()) {
+      data["SubModules.TextDetection.reduced_decode"] =
+          params_.text_det_reduced_decode.value() ? "true" : "false";
+    } else {
+      auto key = it.value().first;
+      data.erase(data.find(key));
+      data[key] = params_.text_det_reduced_decode.value() ? "true" : "false";
+    }
+  }
   if (params_.text_rec_score_thresh.has_value()) {
     auto it = config_.FindKey("TextRecognition.score_thresh");
     if (!it.ok()) {
@@ -764,4 +1214,16 @@ void _OCRPipeline::OverrideConfig() {
       data[key] = Utility::VecToString(params_.text_rec_input_shape.value());
     }
   }
+  if (params_.text_rec_cross_image_batching.has_value()) {
+    auto it = config_.FindKey("TextRecognition.cross_image_batching");
+    if (!it.ok()) {
+      data["SubModules.TextRecognition.cross_image_batching"] =
+          params_.text_rec_cross_image_batching.value() ? "true" : "false";
+    } else {
+      auto key = it.value().first;
+      data.erase(data.find(key));
+      data[key] =
+          params_.text_rec_cross_image_batching.value() ? "true" : "false";
+    }
+  }
 }
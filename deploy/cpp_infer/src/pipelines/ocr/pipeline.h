@@ -25,10 +25,13 @@
 #include "src/base/base_pipeline.h"
 #include "src/common/image_batch_sampler.h"
 #include "src/common/processors.h"
+#include "src/common/staged_executor.h"
+#include "src/common/streaming_image_batch_sampler.h"
 #include "src/modules/image_classification/predictor.h"
 #include "src/modules/text_detection/predictor.h"
 #include "src/modules/text_recognition/predictor.h"
 #include "src/pipelines/doc_preprocessor/pipeline.h"
+#include "src/utils/clone_counter.h"
 #include "src/utils/ilogger.h"
 #include "src/utils/utility.h"
 
@@ -55,6 +58,36 @@ struct OCRPipelineResult {
   std::vector<std::vector<cv::Point2f>> rec_polys = {};
   std::vector<std::array<float, 4>> rec_boxes = {};
   std::string vis_fonts = "";
+  // Bytes deep copied by the work done on this page alone.
+  size_t cloned_bytes = 0;
+  // Bytes deep copied by the model calls that ran this page together with
+  // the rest of its batch. Clones are not traced to pages inside a model
+  // call, so this is the batch total, not divided between its pages.
+  size_t batch_cloned_bytes = 0;
+  // Time spent cutting the text lines out of this page.
+  double crop_time_ms = 0.0;
+};
+
+// Intermediate state of one batch while it moves through the OCR stages.
+// Stages pass images on by header and never write into an image they did not
+// create, so every page is held once however many stages refer to it.
+struct OCRPipelineBatch {
+  std::vector<std::string> input_path = {};
+  std::vector<cv::Mat> input_image = {};
+  std::vector<DocPreprocessorPipelineResult> doc_preprocessor_results = {};
+  std::vector<std::vector<std::vector<cv::Point2f>>> dt_polys_list = {};
+  // Full resolution size of the pages decoded at a reduced size, as
+  // LoadImage recorded it with the EXIF orientation applied, empty for the
+  // others.
+  std::vector<cv::Size> full_sizes = {};
+  std::vector<int> indices = {};
+  std::vector<int> chunk_indices = {};
+  std::vector<cv::Mat> sub_images = {};
+  std::vector<OCRPipelineResult> results = {};
+  // Bytes cloned by the work done on each page alone.
+  std::vector<size_t> page_cloned_bytes = {};
+  // Bytes cloned by the model calls run on all the pages together.
+  size_t cloned_bytes = 0;
 };
 
 struct OCRPipelineParams {
@@ -81,28 +114,50 @@ struct OCRPipelineParams {
   absl::optional<float> text_det_box_thresh = absl::nullopt;
   absl::optional<float> text_det_unclip_ratio = absl::nullopt;
   absl::optional<std::vector<int>> text_det_input_shape = absl::nullopt;
+  absl::optional<std::vector<int>> text_det_bucket_sizes = absl::nullopt;
+  absl::optional<bool> text_det_reduced_decode = absl::nullopt;
   absl::optional<float> text_rec_score_thresh = absl::nullopt;
   absl::optional<std::vector<int>> text_rec_input_shape = absl::nullopt;
+  absl::optional<bool> text_rec_cross_image_batching = absl::nullopt;
   absl::optional<std::string> lang = absl::nullopt;
   absl::optional<std::string> ocr_version = absl::nullopt;
   absl::optional<std::string> vis_font_dir = absl::nullopt;
   absl::optional<std::string> device = absl::nullopt;
+  absl::optional<int> pipeline_batch_size = absl::nullopt;
   bool enable_mkldnn = true;
   int mkldnn_cache_capacity = 10;
   std::string precision = "fp32";
   int cpu_threads = 8;
   int thread_num = 1;
+  std::string parallel_mode = "replica";
+  std::vector<int> stage_replicas = {1, 1, 1, 1};
+  int stage_queue_size = 4;
+  int prefetch_batches = 2;
   absl::optional<Utility::PaddleXConfigVariant> paddlex_config = absl::nullopt;
 };
 
 class _OCRPipeline : public BasePipeline {
 public:
-  explicit _OCRPipeline(const OCRPipelineParams &params);
+  enum Stage {
+    kDocPreprocess = 1,
+    kTextDetection = 2,
+    kTextLineOrientation = 4,
+    kTextRecognition = 8,
+    kAllStages = 15,
+  };
+
+  // Only the models of the given stages are created, the config is always
+  // parsed in full.
+  explicit _OCRPipeline(const OCRPipelineParams &params,
+                        int stages = kAllStages);
   virtual ~_OCRPipeline() = default;
   _OCRPipeline() = delete;
 
   std::vector<std::unique_ptr<BaseCVResult>>
   Predict(const std::vector<std::string> &input) override;
+  std::vector<std::unique_ptr<BaseCVResult>>
+  Predict(const std::vector<cv::Mat> &input,
+          const std::vector<std::string> &input_path) override;
 
   std::vector<OCRPipelineResult> PipelineResult() const {
     return pipeline_result_vec_;
@@ -114,13 +169,28 @@ public:
 
   std::unordered_map<std::string, bool> GetModelSettings() const;
   TextDetParams GetTextDetParams() const { return text_det_params_; };
+  int PipelineBatchSize() const { return pipeline_batch_size_; };
+  CropByPolys::Stats CropStats() const { return crop_by_polys_->GetStats(); };
 
   void OverrideConfig();
 
+  absl::Status PreprocessImages(OCRPipelineBatch &batch);
+  absl::Status DetectText(OCRPipelineBatch &batch);
+  absl::Status ClassifyTextLines(OCRPipelineBatch &batch);
+  absl::Status RecognizeText(OCRPipelineBatch &batch);
+
 private:
+  void PredictBatch(OCRPipelineBatch &batch,
+                    std::vector<std::unique_ptr<BaseCVResult>> &base_results);
+  int DecodeScale(const cv::Size &size) const;
+  absl::StatusOr<StreamingImageBatchSampler::DecodedImage>
+  LoadImage(const std::string &path) const;
+
   OCRPipelineParams params_;
+  int stages_;
   YamlConfig config_;
-  std::unique_ptr<BaseBatchSampler> batch_sampler_ptr_;
+  std::unique_ptr<StreamingImageBatchSampler> batch_sampler_ptr_;
+  int pipeline_batch_size_ = 1;
   std::vector<OCRPipelineResult> pipeline_result_vec_;
   bool use_doc_preprocessor_ = false;
   bool use_doc_orientation_classify_ = false;
@@ -131,32 +201,44 @@ private:
   std::unique_ptr<BasePredictor> text_det_model_;
   std::unique_ptr<BasePredictor> text_rec_model_;
   std::unique_ptr<CropByPolys> crop_by_polys_;
-  std::function<std::vector<std::vector<cv::Point2f>>(
+  std::function<std::vector<size_t>(
       const std::vector<std::vector<cv::Point2f>> &)>
       sort_boxes_;
   float text_rec_score_thresh_ = 0.0;
+  bool text_rec_cross_image_batching_ = false;
+  bool reduced_decode_ = false;
   std::string text_type_;
   TextDetParams text_det_params_;
 };
 
 class OCRPipeline
     : public AutoParallelSimpleInferencePipeline<
-          _OCRPipeline, OCRPipelineParams, std::vector<std::string>,
+          _OCRPipeline, OCRPipelineParams, PipelineInputData,
           std::vector<std::unique_ptr<BaseCVResult>>> {
 public:
-  OCRPipeline(const OCRPipelineParams &params)
-      : AutoParallelSimpleInferencePipeline(params),
-        thread_num_(params.thread_num) {
-    if (thread_num_ == 1) {
-      infer_ = std::unique_ptr<BasePipeline>(new _OCRPipeline(params));
-    }
-  };
+  OCRPipeline(const OCRPipelineParams &params);
 
   std::vector<std::unique_ptr<BaseCVResult>>
   Predict(const std::vector<std::string> &input) override;
+  std::vector<std::unique_ptr<BaseCVResult>>
+  Predict(const std::vector<cv::Mat> &input,
+          const std::vector<std::string> &input_path) override;
 
 private:
+  static OCRPipelineParams ReplicaParams(const OCRPipelineParams &params);
+  absl::Status InitStages(const OCRPipelineParams &params);
+  std::vector<std::unique_ptr<BaseCVResult>>
+  PredictStaged(const std::vector<cv::Mat> &input,
+                const std::vector<std::string> &input_path);
+  std::vector<std::unique_ptr<BaseCVResult>>
+  PredictParallel(const std::vector<cv::Mat> &input,
+                  const std::vector<std::string> &input_path);
+
   int thread_num_;
+  bool staged_ = false;
+  int pipeline_batch_size_ = 1;
   std::unique_ptr<BasePipeline> infer_;
   std::unique_ptr<BaseBatchSampler> batch_sampler_ptr_;
+  std::vector<std::unique_ptr<_OCRPipeline>> stage_pipelines_;
+  std::unique_ptr<StagedExecutor<OCRPipelineBatch>> staged_executor_;
 };
@@ -105,14 +105,19 @@ void OCRResult::SaveToImg(const std::string &save_path) {
   std::unordered_map<std::string, cv::Mat> res_img_dict;
   res_img_dict["ocr_res_img"] = ocr_res_image;
 
+  std::string input_path = pipeline_result_.input_path;
+  if (input_path.empty()) {
+    INFOW("Input path is empty, will use output.png instead!");
+    input_path = "output.png";
+  }
   auto ocr_path = Utility::SmartCreateDirectoryForImage(
-      save_path, pipeline_result_.input_path, "_ocr_res_img");
+      save_path, input_path, "_ocr_res_img");
   if (!ocr_path.ok()) {
     INFOE(ocr_path.status().ToString().c_str());
     exit(-1);
   }
   auto doc_pre_path = Utility::SmartCreateDirectoryForImage(
-      save_path, pipeline_result_.input_path, "_doc_preprocessor_res");
+      save_path, input_path, "_doc_preprocessor_res");
   if (!doc_pre_path.ok()) {
     INFOE(doc_pre_path.status().ToString().c_str());
     exit(-1);
@@ -70,11 +70,22 @@ DEFINE_string(
     "this method. The larger the value, the larger the expansion area.");
 DEFINE_string(text_det_input_shape, "",
               "Input shape of the text detection model.eg C,H,W");
+DEFINE_string(text_det_bucket_sizes, "",
+              "Side lengths that resized images are padded up to before text "
+              "detection, so that images of similar size share a batch. "
+              "eg 640,960,1280");
+DEFINE_string(text_det_reduced_decode, "",
+              "Whether to decode JPEG inputs at a reduced size that still "
+              "covers the text detection input, decoding the full image only "
+              "for cropping text lines.");
 DEFINE_string(text_rec_score_thresh, "0",
               "Text recognition threshold. Text results with scores greater "
               "than this threshold are retained.");
 DEFINE_string(text_rec_input_shape, "",
               "Input shape of the text recognition model.eg C,H,W");
+DEFINE_string(text_rec_cross_image_batching, "",
+              "Whether to pool the text line crops of all images in a pipeline "
+              "batch into shared text recognition batches.");
 DEFINE_string(lang, "", "Language in the input image for OCR processing.");
 DEFINE_string(ocr_version, "", "PP-OCR version to use.");
 #ifdef WITH_GPU
@@ -97,5 +108,16 @@ DEFINE_string(cpu_threads, "8",
               "Number of threads used for paddlepaddle inference on CPU.");
 DEFINE_string(thread_num, "1",
               "Number of threads used for pipeline instance inference on CPU.");
+DEFINE_string(parallel_mode, "replica",
+              "How the OCR pipeline runs in parallel, replica or staged.");
+DEFINE_string(stage_replicas, "",
+              "Workers of the preprocess, detection, textline orientation "
+              "and recognition stages in staged mode, such as 1,1,1,2.");
+DEFINE_string(stage_queue_size, "",
+              "Capacity of the queues between stages in staged mode.");
+DEFINE_string(prefetch_batches, "",
+              "Number of batches decoded ahead of the OCR pipeline.");
+DEFINE_string(pipeline_batch_size, "",
+              "Number of images processed together by each pipeline step.");
 DEFINE_string(paddlex_config, "",
               "Path to the PaddleX pipeline configuration file.");
@@ -39,8 +39,11 @@ DECLARE_string(text_det_thresh);
 DECLARE_string(text_det_box_thresh);
 DECLARE_string(text_det_unclip_ratio);
 DECLARE_string(text_det_input_shape);
+DECLARE_string(text_det_bucket_sizes);
+DECLARE_string(text_det_reduced_decode);
 DECLARE_string(text_rec_score_thresh);
 DECLARE_string(text_rec_input_shape);
+DECLARE_string(text_rec_cross_image_batching);
 DECLARE_string(lang);
 DECLARE_string(ocr_version);
 DECLARE_string(device);
@@ -50,4 +53,9 @@ DECLARE_string(enable_mkldnn);
 DECLARE_string(mkldnn_cache_capacity);
 DECLARE_string(cpu_threads);
 DECLARE_string(thread_num);
+DECLARE_string(parallel_mode);
+DECLARE_string(stage_replicas);
+DECLARE_string(stage_queue_size);
+DECLARE_string(prefetch_batches);
+DECLARE_string(pipeline_batch_size);
 DECLARE_string(paddlex_config);
@@ -0,0 +1,50 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <opencv2/opencv.hpp>
+
+// Images are shared between pipeline stages by cv::Mat header. A stage that
+// needs to modify an image, or a contiguous copy of it, deep copies it through
+// Clone() so the copied bytes show up in the per-page clone counter.
+namespace CloneCounter {
+
+// Bytes copied by Clone() on the calling thread so far.
+inline size_t &ThreadBytes() {
+  static thread_local size_t bytes = 0;
+  return bytes;
+}
+
+inline cv::Mat Clone(const cv::Mat &mat) {
+  ThreadBytes() += mat.total() * mat.elemSize();
+  return mat.clone();
+}
+
+// Adds the bytes cloned on this thread during its lifetime to `*total`.
+class Scope {
+public:
+  explicit Scope(size_t *total) : total_(total), start_(ThreadBytes()) {}
+  ~Scope() { *total_ += ThreadBytes() - start_; }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+private:
+  size_t *total_;
+  size_t start_;
+};
+
+} // namespace CloneCounter
@@ -22,6 +22,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "src/common/tensor_arena.h"
 
 class BaseProcessor {
 public:
@@ -29,4 +30,19 @@ public:
   virtual ~BaseProcessor() = default;
   virtual absl::StatusOr<std::vector<cv::Mat>>
   Apply(std::vector<cv::Mat> &input, const void *param_ptr = nullptr) const = 0;
+
+  // Set by the owning predictor, output tensors are then taken from its
+  // arena instead of the heap.
+  void SetArena(TensorArena *arena) { arena_ = arena; };
+
+protected:
+  cv::Mat AcquireMat(const std::vector<int> &shape, int type) const {
+    if (arena_ != nullptr) {
+      return arena_->Acquire(shape, type);
+    }
+    return cv::Mat(static_cast<int>(shape.size()), shape.data(), type);
+  };
+
+private:
+  TensorArena *arena_ = nullptr;
 };
@@ -17,6 +17,9 @@
 #include <dirent.h>
 #include <sys/stat.h>
 
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <regex>
 
 #include "ilogger.h"
@@ -296,14 +299,143 @@ bool Utility::IsImageFile(const std::string &file_path) {
   return kImgSuffixes.find(lower_ext) != kImgSuffixes.end();
 }
 
-absl::StatusOr<cv::Mat> Utility::MyLoadImage(const std::string &file_path) {
-  cv::Mat image = cv::imread(file_path, cv::IMREAD_COLOR);
+absl::StatusOr<cv::Mat> Utility::MyLoadImage(const std::string &file_path,
+                                              int scale) {
+  int flags = cv::IMREAD_COLOR;
+  if (scale == 2) {
+    flags = cv::IMREAD_REDUCED_COLOR_2;
+  } else if (scale == 4) {
+    flags = cv::IMREAD_REDUCED_COLOR_4;
+  } else if (scale == 8) {
+    flags = cv::IMREAD_REDUCED_COLOR_8;
+  } else if (scale != 1) {
+    return absl::InvalidArgumentError("Unsupported decode scale: " +
+                                      std::to_string(scale));
+  }
+  cv::Mat image = cv::imread(file_path, flags);
   if (image.empty()) {
     return absl::InvalidArgumentError("Failed to load image: " + file_path);
   }
   return image;
 }
 
+// Orientation tag in the first IFD of an EXIF APP1 segment, 0 if there is
+// none or it is out of range.
+static int ExifOrientation(const std::vector<unsigned char> &segment) {
+  if (segment.size() < 14 ||
+      std::memcmp(segment.data(), "Exif\0\0", 6) != 0) {
+    return 0;
+  }
+  const unsigned char *tiff = segment.data() + 6;
+  size_t size = segment.size() - 6;
+  bool little_endian = tiff[0] == 'I' && tiff[1] == 'I';
+  if (!little_endian && !(tiff[0] == 'M' && tiff[1] == 'M')) {
+    return 0;
+  }
+  auto read16 = [&](size_t pos) -> uint32_t {
+    return little_endian ? tiff[pos] | (tiff[pos + 1] << 8)
+                         : (tiff[pos] << 8) | tiff[pos + 1];
+  };
+  auto read32 = [&](size_t pos) -> uint32_t {
+    return little_endian ? read16(pos) | (read16(pos + 2) << 16)
+                         : (read16(pos) << 16) | read16(pos + 2);
+  };
+  size_t ifd = read32(4);
+  if (ifd > size - 2) {
+    return 0;
+  }
+  size_t entries = read16(ifd);
+  for (size_t i = 0; i < entries && ifd + 2 + 12 * (i + 1) <= size; ++i) {
+    size_t entry = ifd + 2 + 12 * i;
+    if (read16(entry) == 0x0112) {
+      uint32_t orientation = read16(entry + 8);
+      return orientation >= 1 && orientation <= 8 ? orientation : 0;
+    }
+  }
+  return 0;
+}
+
+absl::StatusOr<Utility::JpegHeader>
+Utility::ReadJpegHeader(const std::string &file_path) {
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file) {
+    return absl::NotFoundError("Failed to open image: " + file_path);
+  }
+  if (file.get() != 0xFF || file.get() != 0xD8) {
+    return absl::InvalidArgumentError("Not a JPEG file: " + file_path);
+  }
+  JpegHeader jpeg_header;
+  bool exif_seen = false;
+  while (file) {
+    if (file.get() != 0xFF) {
+      break;
+    }
+    int type = file.get();
+    while (type == 0xFF) {
+      type = file.get();
+    }
+    if (type == 0x01 || (type >= 0xD0 && type <= 0xD8)) {
+      continue;
+    }
+    if (type == EOF || type == 0xD9 || type == 0xDA) {
+      break;
+    }
+    unsigned char header[7];
+    if (!file.read(reinterpret_cast<char *>(header), 2)) {
+      break;
+    }
+    int length = (header[0] << 8) | header[1];
+    if (length < 2) {
+      break;
+    }
+    // Any SOFn marker, DHT (C4), JPG (C8) and DAC (CC) share the range.
+    if (type >= 0xC0 && type <= 0xCF && type != 0xC4 && type != 0xC8 &&
+        type != 0xCC) {
+      if (length < 7 || !file.read(reinterpret_cast<char *>(header + 2), 5)) {
+        break;
+      }
+      int height = (header[3] << 8) | header[4];
+      int width = (header[5] << 8) | header[6];
+      if (height == 0 || width == 0) {
+        break;
+      }
+      jpeg_header.size = cv::Size(width, height);
+      return jpeg_header;
+    }
+    // The orientation is taken from the first EXIF segment that has one.
+    if (type == 0xE1 && !exif_seen) {
+      std::vector<unsigned char> segment(length - 2);
+      if (!file.read(reinterpret_cast<char *>(segment.data()),
+                     segment.size())) {
+        break;
+      }
+      int orientation = ExifOrientation(segment);
+      if (orientation != 0) {
+        jpeg_header.orientation = orientation;
+        exif_seen = true;
+      }
+      continue;
+    }
+    file.seekg(length - 2, std::ios::cur);
+  }
+  return absl::InvalidArgumentError("No JPEG frame header found in " +
+                                    file_path);
+}
+
+absl::StatusOr<cv::Mat>
+Utility::MyDecodeImage(const std::vector<unsigned char> &buffer) {
+  if (buffer.empty()) {
+    return absl::InvalidArgumentError("Failed to decode image: empty buffer");
+  }
+  cv::Mat image = cv::imdecode(buffer, cv::IMREAD_COLOR);
+  if (image.empty()) {
+    return absl::InvalidArgumentError(
+        "Failed to decode image from buffer of " +
+        std::to_string(buffer.size()) + " bytes");
+  }
+  return image;
+}
+
 int Utility::MakeDir(const std::string &path) {
 #ifdef _WIN32
   return _mkdir(path.c_str());
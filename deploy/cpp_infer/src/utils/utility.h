@@ -63,6 +63,17 @@ public:
       return map_val;
     }
   };
+  // Frame size of a JPEG file and the EXIF orientation, 1 to 8, that
+  // decoders apply to it; 1 when the file has none.
+  struct JpegHeader {
+    cv::Size size;
+    int orientation = 1;
+    // Size of the image once the orientation is applied. Orientations 5 to
+    // 8 transpose it.
+    cv::Size OrientedSize() const {
+      return orientation >= 5 ? cv::Size(size.height, size.width) : size;
+    }
+  };
   static constexpr const char *MODEL_FILE_PREFIX = "inference";
   static const std::set<std::string> kImgSuffixes;
 
@@ -93,7 +104,15 @@ public:
 
   static absl::StatusOr<std::vector<cv::Mat>> SplitBatch(const cv::Mat &batch);
 
-  static absl::StatusOr<cv::Mat> MyLoadImage(const std::string &file_path);
+  // A scale of 2, 4 or 8 decodes a JPEG at that fraction of its size.
+  static absl::StatusOr<cv::Mat> MyLoadImage(const std::string &file_path,
+                                             int scale = 1);
+  // Reads the frame size and orientation from the header of a JPEG file
+  // without decoding it.
+  static absl::StatusOr<JpegHeader>
+  ReadJpegHeader(const std::string &file_path);
+  static absl::StatusOr<cv::Mat>
+  MyDecodeImage(const std::vector<unsigned char> &buffer);
   static bool IsDirectory(const std::string &path);
   static std::string GetFileExtension(const std::string &file_path);
   static void GetFilesRecursive(const std::string &dir_path,
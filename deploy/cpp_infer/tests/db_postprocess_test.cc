@@ -0,0 +1,351 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/modules/text_detection/processors.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <opencv2/opencv.hpp>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Reaches the private box scoring and unclipping of DBPostProcess.
+class DBPostProcessTestPeer {
+public:
+  explicit DBPostProcessTestPeer(DBPostProcess *post) : post_(post) {}
+
+  float BoxScoreFast(const cv::Mat &bitmap,
+                     const std::vector<cv::Point2f> &contour) {
+    return post_->BoxScoreFast(bitmap, contour);
+  }
+  float BoxScoreSlow(const cv::Mat &bitmap,
+                     const std::vector<cv::Point> &contour) {
+    return post_->BoxScoreSlow(bitmap, contour);
+  }
+  static cv::RotatedRect UnclipRect(const cv::RotatedRect &box,
+                                    float unclip_ratio) {
+    return DBPostProcess::UnclipRect(box, unclip_ratio);
+  }
+
+private:
+  DBPostProcess *post_;
+};
+
+namespace {
+
+typedef std::pair<std::vector<std::vector<cv::Point2f>>, std::vector<float>>
+    PageResult;
+
+const int kHeight = 160;
+const int kWidth = 224;
+
+// N x 1 x kHeight x kWidth probability maps: low noise with rotated text
+// lines of high probability, enough of them that some pages go through the
+// parallel contour path.
+cv::Mat MakePredictions(int batch, int lines, std::mt19937 &rng) {
+  std::vector<int> shape = {batch, 1, kHeight, kWidth};
+  cv::Mat preds(4, shape.data(), CV_32F);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  for (int b = 0; b < batch; ++b) {
+    cv::Mat page(kHeight, kWidth, CV_32F, preds.ptr<float>(b));
+    cv::randu(page, 0.0f, 0.25f);
+    for (int i = 0; i < lines; ++i) {
+      cv::RotatedRect rect(
+          cv::Point2f(unit(rng) * kWidth, unit(rng) * kHeight),
+          cv::Size2f(6 + unit(rng) * 40, 3 + unit(rng) * 6),
+          unit(rng) * 20 - 10);
+      cv::Point2f corners[4];
+      rect.points(corners);
+      std::vector<std::vector<cv::Point>> polygon(1);
+      for (const auto &corner : corners) {
+        polygon[0].emplace_back(static_cast<int>(corner.x),
+                                static_cast<int>(corner.y));
+      }
+      cv::fillPoly(page, polygon, cv::Scalar(0.5 + 0.5 * unit(rng)));
+    }
+  }
+  return preds;
+}
+
+// Source sizes and valid regions of the padded pages, one per batch item.
+std::vector<std::vector<int>> PageShapes(int batch) {
+  std::vector<std::vector<int>> shapes;
+  for (int b = 0; b < batch; ++b) {
+    int valid_h = kHeight - 24 * (b % 3);
+    int valid_w = kWidth - 40 * (b % 2);
+    shapes.push_back({2 * valid_h, 2 * valid_w, valid_h, valid_w});
+  }
+  return shapes;
+}
+
+void ExpectSamePages(const std::vector<PageResult> &actual,
+                     const std::vector<PageResult> &expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t b = 0; b < actual.size(); ++b) {
+    ASSERT_EQ(actual[b].first.size(), expected[b].first.size())
+        << "page " << b;
+    EXPECT_EQ(actual[b].second, expected[b].second) << "page " << b;
+    for (size_t i = 0; i < actual[b].first.size(); ++i) {
+      EXPECT_EQ(actual[b].first[i], expected[b].first[i])
+          << "page " << b << " box " << i;
+    }
+  }
+}
+
+class DBPostProcessTest : public ::testing::TestWithParam<bool> {
+protected:
+  DBPostProcessParams Params() const {
+    DBPostProcessParams params;
+    params.thresh = 0.3f;
+    params.box_thresh = 0.6f;
+    params.unclip_ratio = 1.5f;
+    params.use_dilation = GetParam();
+    return params;
+  }
+
+  std::mt19937 rng_{20250101};
+};
+
+// Binarizing into buffers of the predictor's arena gives the same boxes as
+// binarizing into maps allocated per page, also when the pages of a batch
+// are processed in parallel and the buffers are handed out again.
+TEST_P(DBPostProcessTest, ArenaBuffersMatchPerPageMaps) {
+  const int kBatch = 6;
+  auto shapes = PageShapes(kBatch);
+  DBPostProcess reference(Params());
+  TensorArena arena;
+  DBPostProcess pooled(Params());
+  pooled.SetArena(&arena);
+
+  for (int round = 0; round < 3; ++round) {
+    cv::Mat preds = MakePredictions(kBatch, 20 + 40 * round, rng_);
+    auto expected = reference.Apply(preds, shapes);
+    ASSERT_TRUE(expected.ok()) << expected.status();
+    auto actual = pooled.Apply(preds, shapes);
+    ASSERT_TRUE(actual.ok()) << actual.status();
+    ExpectSamePages(*actual, *expected);
+  }
+
+  // Every page takes its maps at the size of the whole prediction map, so
+  // the buffers are shared by all valid regions and reused across calls.
+  TensorArena::Stats stats = arena.GetStats();
+  EXPECT_GT(stats.reuses, 0u);
+  EXPECT_LT(stats.allocations, stats.acquires);
+}
+
+// A batch gives the same boxes as its pages one at a time.
+TEST_P(DBPostProcessTest, BatchMatchesSinglePages) {
+  const int kBatch = 4;
+  auto shapes = PageShapes(kBatch);
+  cv::Mat preds = MakePredictions(kBatch, 90, rng_);
+  TensorArena arena;
+  DBPostProcess post(Params());
+  post.SetArena(&arena);
+
+  auto batch = post.Apply(preds, shapes);
+  ASSERT_TRUE(batch.ok()) << batch.status();
+  std::vector<PageResult> pages;
+  for (int b = 0; b < kBatch; ++b) {
+    std::vector<int> shape = {1, 1, kHeight, kWidth};
+    cv::Mat page(4, shape.data(), CV_32F, preds.ptr<float>(b));
+    auto single = post.Apply(page, std::vector<std::vector<int>>{shapes[b]});
+    ASSERT_TRUE(single.ok()) << single.status();
+    pages.push_back(single->front());
+  }
+  ExpectSamePages(*batch, pages);
+}
+
+INSTANTIATE_TEST_SUITE_P(Dilation, DBPostProcessTest, ::testing::Bool());
+
+// The box score as it was computed before the scanline fill: a mask per box
+// filled by cv::fillPoly from the truncated ROI-relative corners, and
+// cv::mean over it.
+float MaskedBoxScore(const cv::Mat &bitmap,
+                     const std::vector<cv::Point2f> &contour) {
+  int h = bitmap.size[bitmap.dims - 2];
+  int w = bitmap.size[bitmap.dims - 1];
+  float min_x = contour[0].x, max_x = contour[0].x;
+  float min_y = contour[0].y, max_y = contour[0].y;
+  for (const auto &point : contour) {
+    min_x = std::min(min_x, point.x);
+    max_x = std::max(max_x, point.x);
+    min_y = std::min(min_y, point.y);
+    max_y = std::max(max_y, point.y);
+  }
+  int xmin = std::min(std::max(0, static_cast<int>(std::floor(min_x))), w - 1);
+  int xmax = std::min(std::max(0, static_cast<int>(std::ceil(max_x))), w - 1);
+  int ymin = std::min(std::max(0, static_cast<int>(std::floor(min_y))), h - 1);
+  int ymax = std::min(std::max(0, static_cast<int>(std::ceil(max_y))), h - 1);
+
+  cv::Mat mask = cv::Mat::zeros(ymax - ymin + 1, xmax - xmin + 1, CV_8UC1);
+  std::vector<cv::Point> points;
+  for (auto point : contour) {
+    point.x -= xmin;
+    point.y -= ymin;
+    points.emplace_back(static_cast<int>(point.x), static_cast<int>(point.y));
+  }
+  std::vector<std::vector<cv::Point>> polygons = {points};
+  cv::fillPoly(mask, polygons, cv::Scalar(1));
+  cv::Rect roi(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1);
+  return static_cast<float>(cv::mean(bitmap(roi), mask)[0]);
+}
+
+std::vector<cv::Point2f> Corners(const cv::RotatedRect &rect) {
+  cv::Point2f corners[4];
+  rect.points(corners);
+  return std::vector<cv::Point2f>(corners, corners + 4);
+}
+
+// Both score modes give the masked mean bit for bit: on the boxes and
+// contours of a blurred map like the detector's, on near-horizontal boxes
+// whose edges fall within a pixel row, and on degenerate boxes.
+TEST(DBPostProcessScoreTest, BoxScoresMatchMaskedMean) {
+  std::mt19937 rng(20250317);
+  cv::Mat preds = MakePredictions(1, 60, rng);
+  cv::Mat pred(kHeight, kWidth, CV_32F, preds.ptr<float>(0));
+  cv::GaussianBlur(pred, pred, cv::Size(0, 0), 1.5);
+  DBPostProcessParams params;
+  DBPostProcess post(params);
+  DBPostProcessTestPeer peer(&post);
+
+  cv::Mat segmentation;
+  cv::compare(pred, 0.3, segmentation, cv::CMP_GT);
+  std::vector<std::vector<cv::Point>> contours;
+  cv::findContours(segmentation, contours, cv::RETR_LIST,
+                   cv::CHAIN_APPROX_SIMPLE);
+  ASSERT_GT(contours.size(), 15u);
+  for (const auto &contour : contours) {
+    auto box = Corners(cv::minAreaRect(contour));
+    EXPECT_EQ(peer.BoxScoreFast(pred, box), MaskedBoxScore(pred, box));
+    std::vector<cv::Point2f> float_contour(contour.begin(), contour.end());
+    EXPECT_EQ(peer.BoxScoreSlow(pred, contour),
+              MaskedBoxScore(pred, float_contour));
+  }
+
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  for (int i = 0; i < 2000; ++i) {
+    float x = unit(rng) * (kWidth + 40) - 20;
+    float y = unit(rng) * (kHeight + 40) - 20;
+    float length = 2 + unit(rng) * 200;
+    float thickness = 0.2f + unit(rng) * 3;
+    std::vector<std::vector<cv::Point2f>> boxes = {
+        Corners(cv::RotatedRect(cv::Point2f(x, y),
+                                cv::Size2f(length, 1 + unit(rng) * 30),
+                                unit(rng) * 1.2f - 0.6f)),
+        {{x, y},
+         {x + length, y + unit(rng) * 2 - 1},
+         {x + length, y + thickness},
+         {x, y + thickness}},
+        {{x, y}, {x, y}, {x, y}, {x, y}},
+        {{x, y}, {x + length, y}, {x + length, y}, {x, y}},
+        {{x, y}, {x, y + thickness}, {x, y + thickness}, {x, y}},
+        {{x, y},
+         {x + length, y + length / 3},
+         {x + 2 * length, y + 2 * length / 3},
+         {x + length, y + length / 3}},
+        {{x - 400, y}, {x - 390, y}, {x - 390, y + 5}, {x - 400, y + 5}},
+    };
+    for (const auto &box : boxes) {
+      EXPECT_EQ(peer.BoxScoreFast(pred, box), MaskedBoxScore(pred, box))
+          << "box " << cv::Mat(box).reshape(1);
+    }
+  }
+}
+
+// Every corner of a lies within tolerance of some corner of b. The angle
+// convention of cv::RotatedRect is ambiguous by 90 degrees, the corners are
+// not.
+void ExpectCornersNear(const cv::RotatedRect &a, const cv::RotatedRect &b,
+                       float tolerance) {
+  cv::Point2f corners_a[4], corners_b[4];
+  a.points(corners_a);
+  b.points(corners_b);
+  for (const auto &corner : corners_a) {
+    float nearest = std::numeric_limits<float>::max();
+    for (const auto &other : corners_b) {
+      nearest = std::min(nearest, static_cast<float>(cv::norm(corner - other)));
+    }
+    EXPECT_LE(nearest, tolerance) << "corner " << corner;
+  }
+}
+
+// UnclipRect is the closed form of Unclip on a rectangle. Compare it with the
+// min-area rectangle of what ClipperOffset makes of the same box, as the quad
+// path did before, also for boxes off the pixel grid. Clipper truncates the
+// input corners to integers and rounds its output. On this grid that moves
+// the corners by at most 2.37 px, for the smallest near-square boxes, where
+// the min-area rectangle of the offset polygon also turns.
+TEST(DBPostProcessUnclipTest, UnclipRectMatchesClipperOffset) {
+  const float kAspectRatios[] = {1, 2, 4, 8, 16, 32};
+  const float kUnclipRatios[] = {1.0f, 1.5f, 2.0f, 3.0f};
+  const float kAngles[] = {0, 7.5f, 30, 45, -60, 89};
+  const float kShortSides[] = {4, 10, 24};
+  const cv::Point2f kCenterOffsets[] = {
+      {0.0f, 0.0f}, {0.3f, 0.7f}, {0.5f, 0.5f}, {0.85f, 0.15f}};
+  const float kSideFractions[] = {0.0f, 0.6f};
+  const float kTolerance = 2.4f;
+  for (float aspect_ratio : kAspectRatios) {
+    for (float unclip_ratio : kUnclipRatios) {
+      for (float angle : kAngles) {
+        for (float short_side : kShortSides) {
+          for (const auto &center_offset : kCenterOffsets) {
+            for (float side_fraction : kSideFractions) {
+              float side = short_side + side_fraction;
+              SCOPED_TRACE(::testing::Message()
+                           << "aspect ratio " << aspect_ratio
+                           << ", unclip ratio " << unclip_ratio << ", angle "
+                           << angle << ", short side " << side
+                           << ", center offset " << center_offset);
+              cv::RotatedRect box(cv::Point2f(400, 400) + center_offset,
+                                  cv::Size2f(side * aspect_ratio, side),
+                                  angle);
+              cv::Point2f corners[4];
+              box.points(corners);
+              std::vector<cv::Point2f> polygon(corners, corners + 4);
+              float distance = cv::contourArea(polygon) * unclip_ratio /
+                               cv::arcLength(polygon, true);
+
+              ClipperLib::Path path;
+              for (const auto &point : polygon) {
+                path << ClipperLib::IntPoint(point.x, point.y);
+              }
+              ClipperLib::ClipperOffset offset;
+              offset.AddPath(path, ClipperLib::jtRound,
+                             ClipperLib::etClosedPolygon);
+              ClipperLib::Paths solution;
+              offset.Execute(solution, distance);
+              ASSERT_EQ(solution.size(), 1u);
+              std::vector<cv::Point2f> grown;
+              for (const auto &point : solution[0]) {
+                grown.emplace_back(point.X, point.Y);
+              }
+
+              cv::RotatedRect expected = cv::minAreaRect(grown);
+              cv::RotatedRect actual =
+                  DBPostProcessTestPeer::UnclipRect(box, unclip_ratio);
+              ExpectCornersNear(actual, expected, kTolerance);
+              ExpectCornersNear(expected, actual, kTolerance);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace
@@ -0,0 +1,127 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/utils/utility.h"
+
+namespace {
+
+// EXIF APP1 segment holding only an orientation tag.
+std::vector<uchar> ExifSegment(int orientation, bool little_endian) {
+  auto put16 = [little_endian](std::vector<uchar> &out, int value) {
+    uchar low = value & 0xFF;
+    uchar high = (value >> 8) & 0xFF;
+    out.push_back(little_endian ? low : high);
+    out.push_back(little_endian ? high : low);
+  };
+  auto put32 = [&put16, little_endian](std::vector<uchar> &out, int value) {
+    put16(out, little_endian ? value & 0xFFFF : value >> 16);
+    put16(out, little_endian ? value >> 16 : value & 0xFFFF);
+  };
+  std::vector<uchar> tiff = {little_endian ? uchar('I') : uchar('M'),
+                             little_endian ? uchar('I') : uchar('M')};
+  put16(tiff, 42);
+  put32(tiff, 8);
+  put16(tiff, 1);
+  put16(tiff, 0x0112);
+  put16(tiff, 3);
+  put32(tiff, 1);
+  put16(tiff, orientation);
+  put16(tiff, 0);
+  put32(tiff, 0);
+
+  std::vector<uchar> segment = {0xFF, 0xE1, 0, 0, 'E', 'x', 'i', 'f', 0, 0};
+  segment.insert(segment.end(), tiff.begin(), tiff.end());
+  int length = segment.size() - 2;
+  segment[2] = length >> 8;
+  segment[3] = length & 0xFF;
+  return segment;
+}
+
+// Writes a width x height JPEG, with an EXIF orientation unless it is 0.
+std::string WriteJpeg(const std::string &name, int width, int height,
+                      int orientation, bool little_endian = true) {
+  cv::Mat image(height, width, CV_8UC3);
+  cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+  std::vector<uchar> bytes;
+  EXPECT_TRUE(cv::imencode(".jpg", image, bytes));
+  if (orientation != 0) {
+    auto segment = ExifSegment(orientation, little_endian);
+    bytes.insert(bytes.begin() + 2, segment.begin(), segment.end());
+  }
+  std::string path = ::testing::TempDir() + name;
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  return path;
+}
+
+TEST(JpegHeaderTest, ReadsFrameSizeAndOrientation) {
+  for (bool little_endian : {true, false}) {
+    for (int orientation : {1, 3, 6, 8}) {
+      std::string path = WriteJpeg("header.jpg", 64, 40, orientation,
+                                   little_endian);
+      auto header = Utility::ReadJpegHeader(path);
+      ASSERT_TRUE(header.ok()) << header.status();
+      EXPECT_EQ(header.value().size, cv::Size(64, 40));
+      EXPECT_EQ(header.value().orientation, orientation);
+      EXPECT_EQ(header.value().OrientedSize(),
+                orientation >= 5 ? cv::Size(40, 64) : cv::Size(64, 40));
+    }
+  }
+
+  auto plain = Utility::ReadJpegHeader(WriteJpeg("plain.jpg", 30, 20, 0));
+  ASSERT_TRUE(plain.ok()) << plain.status();
+  EXPECT_EQ(plain.value().size, cv::Size(30, 20));
+  EXPECT_EQ(plain.value().orientation, 1);
+
+  std::string not_jpeg = ::testing::TempDir() + "not_jpeg.jpg";
+  std::ofstream(not_jpeg) << "not a jpeg";
+  EXPECT_FALSE(Utility::ReadJpegHeader(not_jpeg).ok());
+}
+
+class ReducedDecodeTest
+    : public ::testing::TestWithParam<std::tuple<int, int>> {};
+
+// A near-square page turned by its EXIF orientation: the decoder turns it at
+// every scale, so the header predicts the size of a reduced decode and of a
+// full one, even at scales where the reduced page comes out square.
+TEST_P(ReducedDecodeTest, OrientedSizeMatchesDecoder) {
+  int orientation = std::get<0>(GetParam());
+  int scale = std::get<1>(GetParam());
+  std::string path = WriteJpeg("reduced.jpg", 800, 797, orientation);
+  auto header = Utility::ReadJpegHeader(path);
+  ASSERT_TRUE(header.ok()) << header.status();
+  cv::Size full_size = header.value().OrientedSize();
+
+  auto reduced = Utility::MyLoadImage(path, scale);
+  ASSERT_TRUE(reduced.ok()) << reduced.status();
+  EXPECT_EQ(reduced.value().size(),
+            cv::Size((full_size.width + scale - 1) / scale,
+                     (full_size.height + scale - 1) / scale));
+  auto full = Utility::MyLoadImage(path);
+  ASSERT_TRUE(full.ok()) << full.status();
+  EXPECT_EQ(full.value().size(), full_size);
+}
+
+INSTANTIATE_TEST_SUITE_P(Orientations, ReducedDecodeTest,
+                         ::testing::Combine(::testing::Values(1, 3, 6, 8),
+                                            ::testing::Values(2, 4, 8)));
+
+} // namespace
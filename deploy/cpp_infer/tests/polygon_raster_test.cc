@@ -0,0 +1,167 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/common/polygon_raster.h"
+
+#include <opencv2/opencv.hpp>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+cv::Mat Rasterize(const std::vector<cv::Point> &polygon, int width,
+                  int height) {
+  cv::Mat mask = cv::Mat::zeros(height, width, CV_8UC1);
+  PolygonRaster raster(polygon.data(), static_cast<int>(polygon.size()),
+                       width, height);
+  for (int y = 0; y < height; ++y) {
+    const PolygonRaster::Run *runs;
+    int num_runs = raster.Row(y, &runs);
+    int previous_end = -2;
+    for (int i = 0; i < num_runs; ++i) {
+      EXPECT_LE(runs[i].begin, runs[i].end);
+      EXPECT_GT(runs[i].begin, previous_end + 1);
+      EXPECT_GE(runs[i].begin, 0);
+      EXPECT_LT(runs[i].end, width);
+      previous_end = runs[i].end;
+      mask.row(y).colRange(runs[i].begin, runs[i].end + 1).setTo(1);
+    }
+  }
+  return mask;
+}
+
+cv::Mat FillPoly(const std::vector<cv::Point> &polygon, int width,
+                 int height) {
+  cv::Mat mask = cv::Mat::zeros(height, width, CV_8UC1);
+  std::vector<std::vector<cv::Point>> polygons = {polygon};
+  cv::fillPoly(mask, polygons, cv::Scalar(1));
+  return mask;
+}
+
+void ExpectSameAsFillPoly(const std::vector<cv::Point> &polygon, int width,
+                          int height) {
+  cv::Mat diff;
+  cv::compare(Rasterize(polygon, width, height),
+              FillPoly(polygon, width, height), diff, cv::CMP_NE);
+  EXPECT_EQ(cv::countNonZero(diff), 0)
+      << "polygon " << cv::Mat(polygon).reshape(1) << " on " << width << "x"
+      << height;
+}
+
+TEST(PolygonRasterTest, Degenerate) {
+  ExpectSameAsFillPoly({{3, 4}}, 10, 10);
+  ExpectSameAsFillPoly({{1, 1}, {8, 5}}, 10, 10);
+  ExpectSameAsFillPoly({{1, 5}, {8, 5}, {4, 5}}, 10, 10);
+  ExpectSameAsFillPoly({{2, 2}, {2, 2}, {2, 2}, {2, 2}}, 10, 10);
+  ExpectSameAsFillPoly({{-5, -5}, {-1, -5}, {-1, -1}}, 10, 10);
+  ExpectSameAsFillPoly({{0, 0}, {9, 0}, {9, 9}, {0, 9}}, 1, 1);
+}
+
+TEST(PolygonRasterTest, RotatedBoxes) {
+  std::mt19937 rng(20250101);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  for (int i = 0; i < 2000; ++i) {
+    int width = 1 + rng() % 120;
+    int height = 1 + rng() % 120;
+    cv::RotatedRect rect(
+        cv::Point2f(unit(rng) * width, unit(rng) * height),
+        cv::Size2f(1 + unit(rng) * 80, 1 + unit(rng) * 30),
+        unit(rng) * 180 - 90);
+    cv::Point2f corners[4];
+    rect.points(corners);
+    std::vector<cv::Point> polygon;
+    for (const auto &corner : corners) {
+      polygon.emplace_back(static_cast<int>(corner.x),
+                           static_cast<int>(corner.y));
+    }
+    ExpectSameAsFillPoly(polygon, width, height);
+  }
+}
+
+// Text-line boxes whose long edges drop by at most two rows across the image
+// and that are up to three rows thick, so shallow outline runs and fill spans
+// meet on the same rows.
+TEST(PolygonRasterTest, NearHorizontalEdges) {
+  std::mt19937 rng(5);
+  for (int i = 0; i < 2000; ++i) {
+    int width = 8 + rng() % 200;
+    int height = 4 + rng() % 20;
+    int x0 = static_cast<int>(rng() % 20) - 10;
+    int x1 = width - 10 + static_cast<int>(rng() % 20);
+    int y = static_cast<int>(rng() % height);
+    int drop = static_cast<int>(rng() % 5) - 2;
+    int thickness = rng() % 4;
+    ExpectSameAsFillPoly({{x0, y},
+                          {x1, y + drop},
+                          {x1, y + drop + thickness},
+                          {x0, y + thickness}},
+                         width, height);
+  }
+}
+
+// Random, mostly self-intersecting polygons, some of them reaching far off
+// the image and some with more vertices than fit inline.
+TEST(PolygonRasterTest, RandomPolygons) {
+  std::mt19937 rng(7);
+  const int kVertices[] = {3, 4, 5, 8, 16, 17, 40};
+  const int kMargins[] = {0, 5, 200};
+  for (int i = 0; i < 5000; ++i) {
+    int width = 1 + rng() % 60;
+    int height = 1 + rng() % 60;
+    int count = kVertices[rng() % 7];
+    int margin = kMargins[rng() % 3];
+    std::vector<cv::Point> polygon;
+    for (int j = 0; j < count; ++j) {
+      polygon.emplace_back(
+          static_cast<int>(rng() % (width + 2 * margin)) - margin,
+          static_cast<int>(rng() % (height + 2 * margin)) - margin);
+    }
+    ExpectSameAsFillPoly(polygon, width, height);
+  }
+}
+
+TEST(PolygonRasterTest, SumMatchesMaskedSum) {
+  std::mt19937 rng(11);
+  cv::Mat values(64, 80, CV_32FC1);
+  cv::randu(values, 0.0f, 1.0f);
+  cv::Mat roi = values(cv::Rect(3, 5, 70, 50));
+  for (int i = 0; i < 500; ++i) {
+    std::vector<cv::Point> polygon;
+    for (int j = 0; j < 6; ++j) {
+      polygon.emplace_back(static_cast<int>(rng() % 90) - 10,
+                           static_cast<int>(rng() % 70) - 10);
+    }
+    cv::Mat mask = FillPoly(polygon, roi.cols, roi.rows);
+    double expected = 0.0;
+    size_t expected_count = 0;
+    for (int y = 0; y < roi.rows; ++y) {
+      for (int x = 0; x < roi.cols; ++x) {
+        if (mask.at<uchar>(y, x)) {
+          expected += roi.at<float>(y, x);
+          expected_count++;
+        }
+      }
+    }
+    PolygonRaster raster(polygon.data(), static_cast<int>(polygon.size()),
+                         roi.cols, roi.rows);
+    double sum = 0.0;
+    size_t count = raster.Sum(roi.ptr<float>(0), roi.step1(0), &sum);
+    EXPECT_EQ(count, expected_count);
+    EXPECT_EQ(sum, expected);
+  }
+}
+
+} // namespace
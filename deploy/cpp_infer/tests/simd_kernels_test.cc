@@ -0,0 +1,296 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/common/simd_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using SimdKernels::Isa;
+
+// Runs the body once for every instruction set this host supports and puts
+// the detected one back afterwards.
+class SimdKernelsTest : public ::testing::TestWithParam<Isa> {
+protected:
+  void SetUp() override {
+    if (static_cast<int>(GetParam()) >
+        static_cast<int>(SimdKernels::DetectedIsa())) {
+      GTEST_SKIP() << SimdKernels::IsaName(GetParam())
+                   << " is not supported on this host";
+    }
+    SimdKernels::SetActiveIsa(GetParam());
+  }
+  void TearDown() override {
+    SimdKernels::SetActiveIsa(SimdKernels::DetectedIsa());
+  }
+
+  std::mt19937 rng_{20250101};
+};
+
+// Widths below, at and around every vector width, plus a long row.
+const int kWidths[] = {0,  1,  2,  3,  5,  7,  8,  9,  15, 16, 17,
+                       23, 24, 31, 32, 33, 47, 48, 63, 64, 65, 1283};
+// Offsets of the row start from the (aligned) allocation, in elements.
+const int kOffsets[] = {0, 1, 3};
+
+template <typename T> T RandomValue(std::mt19937 &rng);
+template <> uint8_t RandomValue<uint8_t>(std::mt19937 &rng) {
+  return static_cast<uint8_t>(rng() & 0xff);
+}
+template <> float RandomValue<float>(std::mt19937 &rng) {
+  return std::uniform_real_distribution<float>(-300.f, 300.f)(rng);
+}
+
+// Same bit pattern, so -0.0f and NaN payloads count too.
+void ExpectBitEqual(const std::vector<float> &expected,
+                    const std::vector<float> &actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    uint32_t e, a;
+    std::memcpy(&e, &expected[i], sizeof(e));
+    std::memcpy(&a, &actual[i], sizeof(a));
+    ASSERT_EQ(e, a) << "element " << i << ": " << expected[i] << " vs "
+                    << actual[i];
+  }
+}
+
+template <typename T>
+void CheckNormalizeToPlanar(std::mt19937 &rng, int width, int offset,
+                            int src_channels, const std::vector<int> &index) {
+  SCOPED_TRACE(::testing::Message() << "width " << width << " offset " << offset
+                                    << " channels " << src_channels);
+  const int dst_channels = static_cast<int>(index.size());
+  std::vector<T> src(offset + width * src_channels);
+  for (auto &v : src) {
+    v = RandomValue<T>(rng);
+  }
+  std::vector<float> alpha(dst_channels), beta(dst_channels);
+  for (int c = 0; c < dst_channels; ++c) {
+    alpha[c] = std::uniform_real_distribution<float>(-2.f, 2.f)(rng);
+    beta[c] = std::uniform_real_distribution<float>(-3.f, 3.f)(rng);
+  }
+  std::vector<float> expected(offset + width * dst_channels, 0.f);
+  std::vector<float> actual(expected.size(), 0.f);
+  std::vector<float *> expected_planes, actual_planes;
+  for (int c = 0; c < dst_channels; ++c) {
+    expected_planes.push_back(expected.data() + offset + c * width);
+    actual_planes.push_back(actual.data() + offset + c * width);
+  }
+  SimdKernels::Scalar::NormalizeToPlanar(
+      src.data() + offset, width, src_channels, index.data(), alpha.data(),
+      beta.data(), dst_channels, expected_planes.data());
+  SimdKernels::NormalizeToPlanar(src.data() + offset, width, src_channels,
+                                 index.data(), alpha.data(), beta.data(),
+                                 dst_channels, actual_planes.data());
+  ExpectBitEqual(expected, actual);
+}
+
+template <typename T>
+void CheckNormalizeInterleaved(std::mt19937 &rng, int pixels, int offset,
+                               int channels) {
+  SCOPED_TRACE(::testing::Message() << "pixels " << pixels << " offset "
+                                    << offset << " channels " << channels);
+  std::vector<T> src(offset + pixels * channels);
+  for (auto &v : src) {
+    v = RandomValue<T>(rng);
+  }
+  std::vector<float> alpha(channels), beta(channels);
+  for (int c = 0; c < channels; ++c) {
+    alpha[c] = std::uniform_real_distribution<float>(-2.f, 2.f)(rng);
+    beta[c] = std::uniform_real_distribution<float>(-3.f, 3.f)(rng);
+  }
+  std::vector<float> expected(offset + pixels * channels, 0.f);
+  std::vector<float> actual(expected.size(), 0.f);
+  SimdKernels::Scalar::NormalizeInterleaved(src.data() + offset, pixels,
+                                            channels, alpha.data(),
+                                            beta.data(),
+                                            expected.data() + offset);
+  SimdKernels::NormalizeInterleaved(src.data() + offset, pixels, channels,
+                                    alpha.data(), beta.data(),
+                                    actual.data() + offset);
+  ExpectBitEqual(expected, actual);
+}
+
+TEST_P(SimdKernelsTest, NormalizeToPlanarU8MatchesScalar) {
+  const std::vector<std::vector<int>> maps[] = {
+      {},
+      {{0}, {0, 0, 0}},
+      {{0, 1}},
+      {{0, 1, 2}, {2, 1, 0}, {1, 1, 2}},
+      {{0, 1, 2, 3}, {2, 1, 0}}};
+  for (int channels = 1; channels <= 4; ++channels) {
+    for (const auto &index : maps[channels]) {
+      for (int width : kWidths) {
+        for (int offset : kOffsets) {
+          CheckNormalizeToPlanar<uint8_t>(rng_, width, offset, channels, index);
+        }
+      }
+    }
+  }
+}
+
+TEST_P(SimdKernelsTest, NormalizeToPlanarF32MatchesScalar) {
+  const std::vector<std::vector<int>> maps[] = {
+      {}, {{0}, {0, 0, 0}}, {{1, 0}}, {{2, 1, 0}}, {{3, 2, 1}}};
+  for (int channels = 1; channels <= 4; ++channels) {
+    for (const auto &index : maps[channels]) {
+      for (int width : kWidths) {
+        for (int offset : kOffsets) {
+          CheckNormalizeToPlanar<float>(rng_, width, offset, channels, index);
+        }
+      }
+    }
+  }
+}
+
+TEST_P(SimdKernelsTest, NormalizeInterleavedMatchesScalar) {
+  for (int channels = 1; channels <= 5; ++channels) {
+    for (int pixels : kWidths) {
+      for (int offset : kOffsets) {
+        CheckNormalizeInterleaved<uint8_t>(rng_, pixels, offset, channels);
+        CheckNormalizeInterleaved<float>(rng_, pixels, offset, channels);
+      }
+    }
+  }
+}
+
+TEST_P(SimdKernelsTest, NormalizeInterleavedInPlace) {
+  const float alpha[3] = {0.5f, -1.25f, 3.f};
+  const float beta[3] = {-0.5f, 0.25f, 7.f};
+  for (int pixels : kWidths) {
+    std::vector<float> expected(pixels * 3), actual(pixels * 3);
+    for (auto &v : actual) {
+      v = RandomValue<float>(rng_);
+    }
+    SimdKernels::Scalar::NormalizeInterleaved(actual.data(), pixels, 3, alpha,
+                                              beta, expected.data());
+    SimdKernels::NormalizeInterleaved(actual.data(), pixels, 3, alpha, beta,
+                                      actual.data());
+    ExpectBitEqual(expected, actual);
+  }
+}
+
+// Checks index and value bits of ArgMax against the scalar loop on a buffer
+// of exactly n floats, so ASan reports any read past the row.
+void CheckArgMax(const std::vector<float> &row) {
+  const int n = static_cast<int>(row.size());
+  std::unique_ptr<float[]> data(new float[n]);
+  std::copy(row.begin(), row.end(), data.get());
+  float expected_value = 0.f, actual_value = 0.f;
+  int expected = SimdKernels::Scalar::ArgMax(data.get(), n, &expected_value);
+  int actual = SimdKernels::ArgMax(data.get(), n, &actual_value);
+  ASSERT_EQ(expected, actual) << "n " << n;
+  ExpectBitEqual({expected_value}, {actual_value});
+}
+
+const int kArgMaxSizes[] = {1,  2,  7,  8,  9,  31, 32,  33,  63,
+                            64, 65, 97, 128, 130, 6625};
+
+TEST_P(SimdKernelsTest, ArgMaxMatchesScalar) {
+  for (int n : kArgMaxSizes) {
+    for (int trial = 0; trial < 20; ++trial) {
+      std::vector<float> row(n);
+      for (auto &v : row) {
+        v = RandomValue<float>(rng_);
+      }
+      CheckArgMax(row);
+    }
+  }
+}
+
+TEST_P(SimdKernelsTest, ArgMaxTies) {
+  for (int n : kArgMaxSizes) {
+    // Few distinct values, so the maximum repeats in several lanes.
+    std::vector<float> row(n);
+    for (auto &v : row) {
+      v = static_cast<float>(rng_() % 4);
+    }
+    CheckArgMax(row);
+    std::vector<float> flat(n, 0.25f);
+    CheckArgMax(flat);
+    // +0.0 and -0.0 compare equal, the first one wins.
+    std::vector<float> zeros(n, 0.f);
+    for (int i = 0; i < n; i += 2) {
+      zeros[i] = -0.f;
+    }
+    CheckArgMax(zeros);
+  }
+}
+
+TEST_P(SimdKernelsTest, ArgMaxInfinities) {
+  const float inf = std::numeric_limits<float>::infinity();
+  for (int n : kArgMaxSizes) {
+    std::vector<float> row(n, -inf);
+    CheckArgMax(row);
+    for (int pos : {0, n / 2, n - 1}) {
+      std::vector<float> with_inf(n);
+      for (auto &v : with_inf) {
+        v = RandomValue<float>(rng_);
+      }
+      with_inf[pos] = inf;
+      CheckArgMax(with_inf);
+      with_inf[pos] = -inf;
+      CheckArgMax(with_inf);
+    }
+  }
+}
+
+TEST_P(SimdKernelsTest, ArgMaxNaN) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (int n : kArgMaxSizes) {
+    // A NaN in every position: first, inside the vector body, in the tail
+    // and last.
+    for (int pos = 0; pos < n; pos += (n > 200 ? 7 : 1)) {
+      std::vector<float> row(n);
+      for (auto &v : row) {
+        v = RandomValue<float>(rng_);
+      }
+      row[pos] = nan;
+      CheckArgMax(row);
+    }
+    std::vector<float> all_nan(n, nan);
+    CheckArgMax(all_nan);
+    std::vector<float> nan_and_inf(n, nan);
+    nan_and_inf[n - 1] = -std::numeric_limits<float>::infinity();
+    CheckArgMax(nan_and_inf);
+  }
+  // The positions reported against the CTC decoder's 6625 classes.
+  for (int pos : {6616, 6620, 6624}) {
+    std::vector<float> row(6625);
+    for (auto &v : row) {
+      v = RandomValue<float>(rng_);
+    }
+    row[pos] = nan;
+    CheckArgMax(row);
+    row[20] = 1000.f;
+    CheckArgMax(row);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllIsas, SimdKernelsTest,
+                         ::testing::Values(Isa::kScalar, Isa::kAVX2,
+                                           Isa::kAVX512),
+                         [](const ::testing::TestParamInfo<Isa> &info) {
+                           return std::string(SimdKernels::IsaName(info.param));
+                         });
+
+} // namespace
@@ -0,0 +1,179 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/common/tensor_arena.h"
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/common/processors.h"
+#include "src/modules/text_detection/processors.h"
+
+namespace {
+
+TEST(TensorArenaTest, ReusesReleasedBuffers) {
+  TensorArena arena;
+  uchar *data;
+  {
+    cv::Mat mat = arena.Acquire(8, 16, CV_32FC1);
+    data = mat.data;
+  }
+  cv::Mat again = arena.Acquire(8, 16, CV_32FC1);
+  EXPECT_EQ(again.data, data);
+  cv::Mat other_type = arena.Acquire(8, 16, CV_8UC1);
+  cv::Mat other_shape = arena.Acquire({2, 8, 16}, CV_32FC1);
+  cv::Mat held = arena.Acquire(8, 16, CV_32FC1);
+  EXPECT_NE(held.data, again.data);
+
+  TensorArena::Stats stats = arena.GetStats();
+  EXPECT_EQ(stats.acquires, 5u);
+  EXPECT_EQ(stats.reuses, 1u);
+  EXPECT_EQ(stats.allocations, 4u);
+  EXPECT_EQ(stats.allocated_bytes, 8u * 16 * 4 * 2 + 8 * 16 + 2 * 8 * 16 * 4);
+}
+
+// Buffers past the fourth of a shape are handed out but not pooled, so a
+// batch holding six at once allocates two of them on every call.
+TEST(TensorArenaTest, PoolsFourBuffersPerShape) {
+  TensorArena arena;
+  for (int round = 0; round < 3; ++round) {
+    std::vector<cv::Mat> held;
+    for (int i = 0; i < 6; ++i) {
+      held.push_back(arena.Acquire(4, 4, CV_8UC1));
+    }
+    TensorArena::Stats stats = arena.GetStats();
+    EXPECT_EQ(stats.allocations, 6u + 2u * round);
+    EXPECT_EQ(stats.reuses, 4u * round);
+  }
+}
+
+// A 33rd shape drops every idle shape; shapes still in use are kept, and
+// while all 32 are in use a new shape is handed out without being pooled.
+TEST(TensorArenaTest, EvictsIdleShapesPastThirtyTwo) {
+  TensorArena arena;
+  cv::Mat held = arena.Acquire(1, 1, CV_8UC1);
+  for (int i = 2; i <= 32; ++i) {
+    arena.Acquire(1, i, CV_8UC1);
+  }
+  arena.Acquire(1, 2, CV_8UC1);
+  EXPECT_EQ(arena.GetStats().reuses, 1u);
+  EXPECT_EQ(arena.GetStats().allocations, 32u);
+
+  arena.Acquire(1, 33, CV_8UC1);
+  arena.Acquire(1, 2, CV_8UC1);
+  EXPECT_EQ(arena.GetStats().allocations, 34u);
+  cv::Mat again = arena.Acquire(1, 1, CV_8UC1);
+  EXPECT_EQ(arena.GetStats().allocations, 35u);
+  held.release();
+  cv::Mat reused = arena.Acquire(1, 1, CV_8UC1);
+  EXPECT_EQ(arena.GetStats().allocations, 35u);
+
+  TensorArena full(4, 2);
+  cv::Mat a = full.Acquire(1, 1, CV_8UC1);
+  cv::Mat b = full.Acquire(1, 2, CV_8UC1);
+  full.Acquire(1, 3, CV_8UC1);
+  full.Acquire(1, 3, CV_8UC1);
+  EXPECT_EQ(full.GetStats().allocations, 4u);
+  EXPECT_EQ(full.GetStats().reuses, 0u);
+}
+
+struct DetectorRunParam {
+  int pages;
+  bool use_dilation;
+};
+
+class DetectorArenaTest : public ::testing::TestWithParam<DetectorRunParam> {};
+
+// Detector pre- and post-processing sharing one arena, as TextDetPredictor
+// sets them up, run on batches of the same shapes: after the first batch
+// none of them allocates a tensor again.
+TEST_P(DetectorArenaTest, SteadyStateAfterFirstBatch) {
+  TensorArena arena;
+  DetResizeForTestParam resize_param;
+  resize_param.limit_side_len = 96;
+  resize_param.limit_type = "max";
+  DetResizeForTest resize(resize_param);
+  resize.SetArena(&arena);
+  DetPadToBucket bucket({96, 128});
+  bucket.SetArena(&arena);
+  NormalizeToBatch normalize;
+  normalize.SetArena(&arena);
+  DBPostProcessParams db_param;
+  db_param.use_dilation = GetParam().use_dilation;
+  DBPostProcess post(db_param);
+  post.SetArena(&arena);
+
+  std::vector<cv::Mat> images;
+  for (int i = 0; i < GetParam().pages; ++i) {
+    cv::Mat image(150, 200, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    images.push_back(image);
+  }
+
+  auto run = [&]() {
+    auto resized = resize.Apply(images);
+    ASSERT_TRUE(resized.ok()) << resized.status();
+    std::vector<std::vector<int>> shapes;
+    for (size_t i = 0; i < images.size(); ++i) {
+      shapes.push_back({images[i].rows, images[i].cols, resized.value()[i].rows,
+                        resized.value()[i].cols});
+    }
+    auto padded = bucket.Apply(resized.value());
+    ASSERT_TRUE(padded.ok()) << padded.status();
+    auto batch = normalize.Apply(padded.value());
+    ASSERT_TRUE(batch.ok()) << batch.status();
+
+    // The probability map comes from the predictor, not the arena.
+    const cv::Mat &input = batch.value()[0];
+    std::vector<int> pred_shape = {input.size[0], 1, input.size[2],
+                                   input.size[3]};
+    cv::Mat preds(4, pred_shape.data(), CV_32F);
+    cv::Mat flat = preds.reshape(1, 1);
+    cv::randu(flat, 0.0f, 0.25f);
+    for (int b = 0; b < pred_shape[0]; ++b) {
+      cv::Mat page(pred_shape[2], pred_shape[3], CV_32F, preds.ptr<float>(b));
+      page(cv::Rect(8, 10 + 4 * b, 40, 8)).setTo(0.9);
+    }
+    auto result = post.Apply(preds, shapes);
+    ASSERT_TRUE(result.ok()) << result.status();
+    ASSERT_EQ(result.value().size(), images.size());
+    for (const auto &page : result.value()) {
+      EXPECT_EQ(page.first.size(), 1u);
+    }
+  };
+
+  run();
+  TensorArena::Stats warm = arena.GetStats();
+  EXPECT_GT(warm.allocations, 0u);
+  for (int i = 0; i < 3; ++i) {
+    run();
+  }
+  TensorArena::Stats stats = arena.GetStats();
+  EXPECT_EQ(stats.allocations, warm.allocations);
+  EXPECT_EQ(stats.allocated_bytes, warm.allocated_bytes);
+  EXPECT_EQ(stats.reuses - warm.reuses, 3 * warm.acquires);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Batches, DetectorArenaTest,
+    ::testing::Values(DetectorRunParam{1, false}, DetectorRunParam{4, false},
+                      DetectorRunParam{2, true}),
+    [](const ::testing::TestParamInfo<DetectorRunParam> &info) {
+      return std::to_string(info.param.pages) +
+             (info.param.use_dilation ? "PagesDilated" : "Pages");
+    });
+
+} // namespace
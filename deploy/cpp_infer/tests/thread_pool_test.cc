@@ -0,0 +1,140 @@
+// Copyright (c) 2025 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/common/thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <mutex>
+#include <new>
+#include <opencv2/opencv.hpp>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/utils/clone_counter.h"
+
+namespace {
+
+std::atomic<size_t> allocations(0);
+
+} // namespace
+
+void *operator new(size_t size) {
+  ++allocations;
+  void *ptr = std::malloc(size ? size : 1);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+// Tasks posted from several threads at once, each burst waited for before
+// the next, so a worker that parks past a queued task hangs the test.
+TEST(ThreadPoolTest, RunsTasksPostedFromManyThreads) {
+  PaddlePool::ThreadPool pool(4);
+  std::atomic<int> ran(0);
+  const int posters = 4;
+  const int bursts = 500;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < posters; ++t) {
+    threads.emplace_back([&]() {
+      for (int b = 0; b < bursts; ++b) {
+        std::atomic<int> left(3);
+        for (int i = 0; i < 3; ++i) {
+          pool.post([&]() {
+            ++ran;
+            --left;
+          });
+        }
+        while (left.load() > 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(ran.load(), posters * bursts * 3);
+  EXPECT_EQ(pool.submit([]() { return 7; }).get(), 7);
+}
+
+TEST(ParallelForTest, CallsEveryIndexOnce) {
+  std::vector<std::atomic<int>> calls(1000);
+  for (auto &count : calls) {
+    count = 0;
+  }
+  PaddlePool::parallelFor(calls.size(), [&](size_t i) { ++calls[i]; });
+  for (size_t i = 0; i < calls.size(); ++i) {
+    EXPECT_EQ(calls[i].load(), 1) << "index " << i;
+  }
+}
+
+// Clones made on the workers are counted by a scope on the calling thread,
+// once each, including those of a parallelFor nested inside another.
+TEST(ParallelForTest, CountsClonesOfWorkers) {
+  cv::Mat image(16, 32, CV_8UC3, cv::Scalar::all(7));
+  const size_t image_bytes = 16 * 32 * 3;
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  size_t total = 0;
+  {
+    CloneCounter::Scope scope(&total);
+    PaddlePool::parallelFor(32, [&](size_t) {
+      CloneCounter::Clone(image);
+      PaddlePool::parallelFor(2,
+                              [&](size_t) { CloneCounter::Clone(image); });
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(std::this_thread::get_id());
+    });
+  }
+  EXPECT_EQ(total, 32 * 3 * image_bytes);
+  if (PaddlePool::sharedPool().threadsNum() > 1) {
+    EXPECT_GT(threads.size(), 1u);
+  }
+
+  size_t after = 0;
+  {
+    CloneCounter::Scope scope(&after);
+    PaddlePool::parallelFor(8, [&](size_t) {});
+  }
+  EXPECT_EQ(after, 0u);
+}
+
+// Once the pool's queues have grown to the loop's size, a loop allocates
+// nothing, on the caller or on the workers.
+TEST(ParallelForTest, DoesNotAllocate) {
+  std::atomic<size_t> sum(0);
+  std::function<void(size_t)> add = [&sum](size_t i) { sum += i; };
+  PaddlePool::parallelFor(64, add);
+  size_t before = allocations.load();
+  for (int i = 0; i < 100; ++i) {
+    PaddlePool::parallelFor(64, add);
+  }
+  EXPECT_EQ(allocations.load(), before);
+  EXPECT_EQ(sum.load(), 101u * 64 * 63 / 2);
+}
+
+} // namespace